@@ -0,0 +1,103 @@
+#include "AssetLoader.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+const size_t MAX_ASSET_WORKERS = 2;
+
+AssetLoader::AssetLoader(size_t workerCount) {
+    workerCount = std::max<size_t>(workerCount, 1);
+    for (size_t i = 0; i < workerCount; ++i) workers.emplace_back(&AssetLoader::WorkerLoop, this);
+}
+
+AssetLoader::~AssetLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        requests.clear();
+    }
+    wakeWorkers.notify_all();
+    for (std::thread& worker : workers) worker.join();
+
+    for (Decoded& result : decoded) Free(result);
+}
+
+// Decoding is mostly waiting on the disk and the decompressor, so a couple of threads are enough
+// and leave the rest of the cores to the JobSystem
+size_t AssetLoader::DefaultWorkerCount() {
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return std::clamp<size_t>(hardwareThreads > 1 ? hardwareThreads - 1 : 1, 1, MAX_ASSET_WORKERS);
+}
+
+void AssetLoader::Submit(Request request) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.push_back({ std::move(request), generation });
+    }
+    wakeWorkers.notify_one();
+}
+
+bool AssetLoader::PollDecoded(Decoded& result) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (decoded.empty()) return false;
+
+    result = decoded.front();
+    decoded.pop_front();
+    return true;
+}
+
+size_t AssetLoader::GetPendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return requests.size() + decoding + decoded.size();
+}
+
+void AssetLoader::CancelAll() {
+    std::lock_guard<std::mutex> lock(mutex);
+    requests.clear();
+    for (Decoded& result : decoded) Free(result);
+    decoded.clear();
+    generation++;
+}
+
+AssetLoader::Decoded AssetLoader::Decode(const Request& request) {
+    auto start = std::chrono::steady_clock::now();
+    Decoded result{ request.kind, request.index };
+
+    if (request.kind == AssetKind::Texture) {
+        result.image = LoadImage(request.path.c_str());
+        if (!result.image.data) result.image = GenImageColor(request.width, request.height, request.fallbackColor);
+    }
+    else if (std::filesystem::exists(request.path)) {
+        result.wave = LoadWave(request.path.c_str());
+    }
+
+    result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void AssetLoader::Free(Decoded& result) {
+    if (result.image.data) UnloadImage(result.image);
+    if (result.wave.data) UnloadWave(result.wave);
+    result.image = {};
+    result.wave = {};
+}
+
+void AssetLoader::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeWorkers.wait(lock, [this] { return !requests.empty() || stopping; });
+        if (stopping) return;
+
+        QueuedRequest queued = std::move(requests.front());
+        requests.pop_front();
+        decoding++;
+        lock.unlock();
+
+        Decoded result = Decode(queued.request);
+
+        lock.lock();
+        decoding--;
+        if (queued.generation == generation) decoded.push_back(result);
+        else Free(result);
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "raylib.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Decodes image and audio files on worker threads. Nothing here touches the GPU or the audio
+// device: ResourceManager hands the decoded pixels and samples to raylib on the main thread.
+class AssetLoader {
+public:
+    enum class AssetKind {
+        Texture,
+        Sound
+    };
+
+    // What to decode. A texture whose file is missing or unreadable is generated as a
+    // width x height image in fallbackColor instead.
+    struct Request {
+        AssetKind kind;
+        uint32_t index; // Handed back unchanged, so the caller can tell which asset this is
+        std::string path;
+        int width = 0;
+        int height = 0;
+        Color fallbackColor = {};
+    };
+
+    // The caller takes ownership of image or wave
+    struct Decoded {
+        AssetKind kind = AssetKind::Texture;
+        uint32_t index = 0;
+        Image image = {};
+        Wave wave = {};            // Empty when the sound file was missing or unreadable
+        double milliseconds = 0.0; // Decode time on the worker
+    };
+
+    explicit AssetLoader(size_t workerCount = DefaultWorkerCount());
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+    // Drops the requests not yet started and waits for the ones being decoded
+    ~AssetLoader();
+
+    static size_t DefaultWorkerCount();
+
+    void Submit(Request request);
+    // Hands back one finished decode, oldest first, without blocking
+    bool PollDecoded(Decoded& decoded);
+    // Requests not yet handed back by PollDecoded, counting cancelled ones still being decoded
+    size_t GetPendingCount() const;
+    // Forgets every request. Decodes already running are thrown away when they finish.
+    void CancelAll();
+
+private:
+    struct QueuedRequest {
+        Request request;
+        uint64_t generation;
+    };
+
+    std::deque<QueuedRequest> requests;
+    std::deque<Decoded> decoded;
+    size_t decoding = 0;
+    uint64_t generation = 0; // Bumped by CancelAll
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeWorkers;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    static Decoded Decode(const Request& request);
+    static void Free(Decoded& decoded);
+    void WorkerLoop();
+};
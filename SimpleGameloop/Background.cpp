@@ -1,48 +1,84 @@
 #include "Background.h"
+#include "ObjectPool.h"
+#include <cmath>
 
 constexpr float B_ACCELERATION = 400.0f;
 
 Background::Background(ResourceManager& resourceManager, const std::string& texturePath, float scrollSpeed)
-    : Sprite({ 0, 0 }, { 0, 0 }, 0.0, { 0, 0 }, Rectangular, false), texturePath(texturePath), resourceManager(resourceManager), scrollSpeed(scrollSpeed) {
-    texture = resourceManager.GetTexture(texturePath);
-    size = Vector2{ static_cast<float>(texture.width), static_cast<float>(texture.height) };
+    : Background(resourceManager, resourceManager.GetSpriteAssets(texturePath, ""), scrollSpeed) {}
+
+Background::Background(ResourceManager& resourceManager, SpriteAssets assets, float scrollSpeed)
+    : Sprite(TYPE, { 0, 0 }, { 0, 0 }, 0.0, { 0, 0 }, Rectangular, false), texture(assets.texture),
+    resourceManager(resourceManager), scrollSpeed(scrollSpeed) {
+    resourceManager.Retain(texture);
+}
+
+Background::~Background() {
+    resourceManager.Release(texture);
+}
+
+SpriteAssets Background::GetDefaultAssets(ResourceManager& resourceManager, Vector2 size) {
+    return resourceManager.GetSpriteAssets(DEFAULT_TEXTURE, "");
 }
 
-void Background::Update(float deltaTime, int screenWidth, int screenHeight) {
-    if (IsKeyDown(KEY_W)) velocity.y -= B_ACCELERATION * deltaTime;
-    if (IsKeyDown(KEY_S)) velocity.y += B_ACCELERATION * deltaTime;
-    if (IsKeyDown(KEY_A)) velocity.x -= B_ACCELERATION * deltaTime;
-    if (IsKeyDown(KEY_D)) velocity.x += B_ACCELERATION * deltaTime;
+std::shared_ptr<Sprite> Background::Create(ResourceManager& resourceManager, Vector2 position, Vector2 size, Vector2 velocity, const SpriteAssets& assets) {
+    return ObjectPool::MakeShared<Background>(resourceManager, assets);
+}
+
+void Background::Update(float deltaTime, int screenWidth, int screenHeight, const InputState& input) {
+    Vector2& velocity = Velocity();
+    Vector2& position = Position();
+
+    if (input.IsDown(InputState::MoveUp)) velocity.y -= B_ACCELERATION * deltaTime;
+    if (input.IsDown(InputState::MoveDown)) velocity.y += B_ACCELERATION * deltaTime;
+    if (input.IsDown(InputState::MoveLeft)) velocity.x -= B_ACCELERATION * deltaTime;
+    if (input.IsDown(InputState::MoveRight)) velocity.x += B_ACCELERATION * deltaTime;
 
-    Vector2 scrollDelta = GetMouseWheelMoveV();
+    Vector2 scrollDelta = input.wheelMove;
 
     position.x += scrollDelta.x * scrollSpeed;
     position.y += scrollDelta.y * scrollSpeed;
 
-    if (position.x <= -texture.width) position.x += texture.width;
-    if (position.x > 0) position.x -= texture.width;
-    if (position.y <= -texture.height) position.y += texture.height;
-    if (position.y > 0) position.y -= texture.height;
+    // Covers the screen. The tile size is left out of the simulation: it is only known once the
+    // texture has loaded, and headless runs fake it, so a replay would diverge from the live run.
+    Size() = Vector2{ static_cast<float>(screenWidth), static_cast<float>(screenHeight) };
 }
 
-void Background::Draw(int global_x, int global_y) const {
-    for (int x = static_cast<int>(global_x); x < GetScreenWidth(); x += texture.width)
-        for (int y = static_cast<int>(global_y); y < GetScreenHeight(); y += texture.height)
-            DrawTexture(texture, x, y, WHITE);
+// Tiles the viewport from the scroll position, wrapped to within one tile of the origin. Nothing is
+// drawn while the texture is loading, since tiling the placeholder would cover the screen in tiny quads.
+void Background::QueueDraw(RenderQueue& queue, uint32_t order, Vector2 position, float rotation) const {
+    if (!resourceManager.IsLoaded(texture)) return;
+    const AtlasRegion& region = resourceManager.GetTexture(texture);
+    const Rectangle& source = region.source;
+    if (source.width <= 0 || source.height <= 0) return;
+
+    const Rectangle& viewport = queue.GetViewport();
+    float offsetX = std::fmod(position.x, source.width);
+    float offsetY = std::fmod(position.y, source.height);
+    if (offsetX > 0) offsetX -= source.width;
+    if (offsetY > 0) offsetY -= source.height;
+
+    int tileWidth = static_cast<int>(source.width);
+    int tileHeight = static_cast<int>(source.height);
+    for (int x = static_cast<int>(offsetX); x < viewport.x + viewport.width; x += tileWidth)
+        for (int y = static_cast<int>(offsetY); y < viewport.y + viewport.height; y += tileHeight)
+            queue.Add({ BackgroundLayer, order, region.texture, source, { (float)x, (float)y, source.width, source.height }, { 0, 0 }, 0.0f });
 }
 
-void Background::Save(std::ofstream& file) const {
-    Sprite::Save(file);
+void Background::Save(EntityRecord& record, SnapshotStringTable& strings) const {
+    Sprite::Save(record, strings);
 
-    resourceManager.SaveResourceKey(file, texturePath);
-    file.write(reinterpret_cast<const char*>(&scrollSpeed), sizeof(scrollSpeed));
+    record.texture = strings.Intern(resourceManager.GetTexturePath(texture));
+    record.params[0] = scrollSpeed;
 }
 
-void Background::Load(std::ifstream& file) {
-    Sprite::Load(file);
+void Background::Load(const EntityRecord& record, const SnapshotStringTable& strings) {
+    Sprite::Load(record, strings);
 
-    texturePath = resourceManager.LoadResourceKey(file);
-    texture = resourceManager.GetTexture(texturePath);
+    TextureHandle loadedTexture = resourceManager.RequestTexture(strings, record.texture);
+    resourceManager.Retain(loadedTexture);
+    resourceManager.Release(texture);
+    texture = loadedTexture;
 
-    file.read(reinterpret_cast<char*>(&scrollSpeed), sizeof(scrollSpeed));
+    scrollSpeed = record.params[0];
 }
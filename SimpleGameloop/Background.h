@@ -2,20 +2,33 @@
 #include "Sprite.h"
 #include "raylib.h"
 #include "ResourceManager.h"
+#include <memory>
 
 class Background : public Sprite {
 private:
-    std::string texturePath;
-    Texture2D texture;
+    TextureHandle texture;
     ResourceManager& resourceManager;
 
     float scrollSpeed;
 
 public:
-    Background(ResourceManager& resourceManager, const std::string& texturePath = "resources/background2.png", float scrollSpeed = 100.0f);
+    static constexpr SpriteType TYPE = SpriteType::BackgroundSprite;
+    static constexpr const char* TYPE_NAME = "Background";
+    static constexpr const char* DEFAULT_TEXTURE = "resources/background2.png";
 
-    void Update(float deltaTime, int screenWidth, int screenHeight) override;
-    void Draw(int global_x, int global_y) const override;
-    void Save(std::ofstream& file) const override;
-    void Load(std::ifstream& file) override;
+    Background(ResourceManager& resourceManager, const std::string& texturePath = DEFAULT_TEXTURE, float scrollSpeed = 100.0f);
+    // assets.sound is ignored; backgrounds make no sound
+    Background(ResourceManager& resourceManager, SpriteAssets assets, float scrollSpeed = 100.0f);
+
+    ~Background() override;
+
+    // SpriteRegistry hooks
+    static SpriteAssets GetDefaultAssets(ResourceManager& resourceManager, Vector2 size);
+    static std::shared_ptr<Sprite> Create(ResourceManager& resourceManager, Vector2 position, Vector2 size, Vector2 velocity, const SpriteAssets& assets);
+
+    void Update(float deltaTime, int screenWidth, int screenHeight, const InputState& input) override;
+    void QueueDraw(RenderQueue& queue, uint32_t order, Vector2 position, float rotation) const override;
+    bool IsAlwaysVisible() const override { return true; }
+    void Save(EntityRecord& record, SnapshotStringTable& strings) const override;
+    void Load(const EntityRecord& record, const SnapshotStringTable& strings) override;
 };
@@ -0,0 +1,47 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+// Little-endian encoding helpers shared by the snapshot and input recording formats
+
+inline uint32_t ToLittleEndian(uint32_t value) {
+    if constexpr (std::endian::native == std::endian::little) return value;
+    return (value >> 24) | ((value >> 8) & 0xFF00u) | ((value << 8) & 0xFF0000u) | (value << 24);
+}
+
+inline void PutWord(uint8_t* destination, uint32_t value) {
+    value = ToLittleEndian(value);
+    std::memcpy(destination, &value, sizeof(value));
+}
+
+inline uint32_t GetWord(const uint8_t* source) {
+    uint32_t value;
+    std::memcpy(&value, source, sizeof(value));
+    return ToLittleEndian(value);
+}
+
+// LEB128-style variable length integers: seven bits per byte, lowest group first, high bit set on
+// every byte but the last
+
+inline void PutVarint(std::vector<uint8_t>& buffer, uint32_t value) {
+    while (value >= 0x80) {
+        buffer.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<uint8_t>(value));
+}
+
+// Advances cursor past the value; throws if it runs past end or is longer than five bytes
+inline uint32_t GetVarint(const uint8_t*& cursor, const uint8_t* end) {
+    uint32_t value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (cursor == end) throw std::runtime_error("Varint runs past the end of the buffer");
+        uint8_t byte = *cursor++;
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    throw std::runtime_error("Overlong varint");
+}
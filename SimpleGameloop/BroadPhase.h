@@ -0,0 +1,27 @@
+#pragma once
+#include "SceneNode.h"
+#include <vector>
+#include <memory>
+#include <utility>
+
+enum class BroadPhaseType {
+    Quadtree,
+    SweepAndPrune,
+    SpatialHash
+};
+
+// Spatial structure GameState::Update files every node into once per tick and then asks for the
+// candidate pairs the narrow phase should test
+class BroadPhase {
+public:
+    virtual ~BroadPhase() = default;
+
+    virtual void Clear() = 0;
+    // Re-files a node whose bounds may have changed; inserts it if it is not tracked yet
+    virtual void Update(const std::shared_ptr<SceneNode>& node) = 0;
+    virtual void Remove(SceneNode& node) = 0;
+    // Every pair of collidable nodes that may overlap, each pair reported exactly once
+    virtual void CollectPairs(std::vector<std::pair<SceneNode*, SceneNode*>>& pairs) = 0;
+    // Appends every node that may overlap rect to a caller-owned buffer
+    virtual void Retrieve(const Rectangle& rect, std::vector<SceneNode*>& result) const = 0;
+};
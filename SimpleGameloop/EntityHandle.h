@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+
+// Names one entity in a GameState. The slot index is reused after the entity is removed, but the
+// slot's generation is bumped at the same time, so a handle to a removed entity never resolves
+// to whatever took its slot. The default handle is invalid.
+struct EntityHandle {
+    static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+    // Upper bound on slot indices accepted from snapshots
+    static constexpr uint32_t MAX_INDEX = 1u << 26;
+
+    uint32_t index = INVALID_INDEX;
+    uint32_t generation = 0;
+
+    bool IsValid() const { return index != INVALID_INDEX; }
+    bool operator==(const EntityHandle& other) const = default;
+};
@@ -0,0 +1,127 @@
+#include "EntityStore.h"
+#include "Sprite.h"
+#include <cmath>
+#include <algorithm>
+
+EntityStore* EntityStore::creationTarget = nullptr;
+
+EntityStore::~EntityStore() {
+    if (this == &Unattached()) return;
+    while (!owners.empty()) Unattached().Adopt(*owners.back());
+}
+
+EntityStore& EntityStore::Unattached() {
+    static EntityStore unattached;
+    return unattached;
+}
+
+EntityStore& EntityStore::CreationTarget() {
+    return creationTarget ? *creationTarget : Unattached();
+}
+
+void EntityStore::Reserve(size_t count) {
+    if (count <= owners.capacity()) return;
+    count = std::max(count, owners.capacity() * 2);
+
+    positions.reserve(count);
+    velocities.reserve(count);
+    sizes.reserve(count);
+    rotations.reserve(count);
+    shapes.reserve(count);
+    collidable.reserve(count);
+    parentOffsets.reserve(count);
+    previousPositions.reserve(count);
+    previousRotations.reserve(count);
+    owners.reserve(count);
+}
+
+size_t EntityStore::Allocate(Sprite* owner, Vector2 position, Vector2 size, float rotation, Vector2 velocity, ShapeType shape, bool isCollidable) {
+    positions.push_back(position);
+    velocities.push_back(velocity);
+    sizes.push_back(size);
+    rotations.push_back(rotation);
+    shapes.push_back(shape);
+    collidable.push_back(isCollidable);
+    parentOffsets.push_back({ 0, 0 });
+    previousPositions.push_back(position);
+    previousRotations.push_back(rotation);
+    owners.push_back(owner);
+    return owners.size() - 1;
+}
+
+void EntityStore::Release(size_t slot) {
+    size_t last = owners.size() - 1;
+    if (slot != last) {
+        positions[slot] = positions[last];
+        velocities[slot] = velocities[last];
+        sizes[slot] = sizes[last];
+        rotations[slot] = rotations[last];
+        shapes[slot] = shapes[last];
+        collidable[slot] = collidable[last];
+        parentOffsets[slot] = parentOffsets[last];
+        previousPositions[slot] = previousPositions[last];
+        previousRotations[slot] = previousRotations[last];
+        owners[slot] = owners[last];
+        owners[slot]->slot = slot;
+    }
+
+    positions.pop_back();
+    velocities.pop_back();
+    sizes.pop_back();
+    rotations.pop_back();
+    shapes.pop_back();
+    collidable.pop_back();
+    parentOffsets.pop_back();
+    previousPositions.pop_back();
+    previousRotations.pop_back();
+    owners.pop_back();
+}
+
+void EntityStore::Adopt(Sprite& sprite) {
+    EntityStore& from = *sprite.store;
+    if (&from == this) return;
+
+    size_t oldSlot = sprite.slot;
+    size_t newSlot = Allocate(&sprite, from.positions[oldSlot], from.sizes[oldSlot], from.rotations[oldSlot],
+        from.velocities[oldSlot], from.shapes[oldSlot], from.collidable[oldSlot] != 0);
+    parentOffsets[newSlot] = from.parentOffsets[oldSlot];
+    previousPositions[newSlot] = from.previousPositions[oldSlot];
+    previousRotations[newSlot] = from.previousRotations[oldSlot];
+
+    from.Release(oldSlot);
+    sprite.store = this;
+    sprite.slot = newSlot;
+}
+
+void EntityStore::SavePreviousState() {
+    previousPositions = positions;
+    previousRotations = rotations;
+}
+
+Vector2 EntityStore::InterpolatePosition(size_t slot, float alpha) const {
+    Vector2 previous = previousPositions[slot];
+    Vector2 current = positions[slot];
+    if (std::fabs(current.x - previous.x) >= sizes[slot].x || std::fabs(current.y - previous.y) >= sizes[slot].y) return current;
+
+    return { previous.x + (current.x - previous.x) * alpha, previous.y + (current.y - previous.y) * alpha };
+}
+
+// Rotations are in degrees and wrap where atan2 does, so blend along the shorter arc
+float EntityStore::InterpolateRotation(size_t slot, float alpha) const {
+    float previous = previousRotations[slot];
+    float difference = std::remainder(rotations[slot] - previous, 360.0f);
+    return previous + difference * alpha;
+}
+
+void EntityStore::Step(float deltaTime, int screenWidth, int screenHeight, std::vector<size_t>& hits) {
+    StepRange(0, Size(), deltaTime, screenWidth, screenHeight, hits);
+}
+
+void EntityStore::StepRange(size_t begin, size_t end, float deltaTime, int screenWidth, int screenHeight, std::vector<size_t>& hits) {
+    BodyArrays bodies = { positions.data() + begin, velocities.data() + begin, sizes.data() + begin,
+        parentOffsets.data() + begin, collidable.data() + begin, end - begin };
+
+    size_t firstHit = hits.size();
+    PhysicsKernel::IntegrateAndConstrain(simdLevel, bodies, deltaTime, screenWidth, screenHeight, hits);
+    for (size_t i = firstHit; i < hits.size(); ++i) hits[i] += begin;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "raylib.h"
+#include "ShapeType.h"
+#include "PhysicsKernel.h"
+#include <vector>
+#include <cstdint>
+
+class Sprite;
+
+// Structure-of-arrays storage for the transform and physics state of a set of Sprites.
+// Each GameState owns one and steps only that; sprites start out in Unattached() and move into a
+// GameState's store when they are registered with it.
+// Sprites only hold their store and slot index; slots stay dense because removing one moves the
+// last slot into the hole and re-points its owner, so per-tick passes are plain linear loops.
+class EntityStore {
+private:
+    static EntityStore* creationTarget;
+    SimdLevel simdLevel = PhysicsKernel::DetectSimdLevel();
+
+public:
+    std::vector<Vector2> positions;
+    std::vector<Vector2> velocities;
+    std::vector<Vector2> sizes;
+    std::vector<float> rotations;
+    std::vector<ShapeType> shapes;
+    std::vector<uint8_t> collidable;
+    std::vector<Vector2> parentOffsets; // Global position of the owning node's parent
+    std::vector<Vector2> previousPositions; // State at the start of the last tick, for interpolation
+    std::vector<float> previousRotations;
+    std::vector<Sprite*> owners;
+
+    EntityStore() = default;
+    EntityStore(const EntityStore&) = delete;
+    EntityStore& operator=(const EntityStore&) = delete;
+    // Sprites that outlive the store, e.g. still held after their GameState is gone, go back to Unattached()
+    ~EntityStore();
+
+    // Where sprites live until a GameState adopts them. Nothing steps it.
+    static EntityStore& Unattached();
+    // Where a new Sprite allocates its slot: Unattached() unless a CreationScope is open
+    static EntityStore& CreationTarget();
+
+    // Sprites constructed while it is alive go straight into store, so a batch built for a GameState
+    // is written once, into the store that owns it. Main thread only, like sprite creation itself.
+    class CreationScope {
+    private:
+        EntityStore* previous;
+
+    public:
+        explicit CreationScope(EntityStore& store) : previous(creationTarget) { creationTarget = &store; }
+        CreationScope(const CreationScope&) = delete;
+        CreationScope& operator=(const CreationScope&) = delete;
+        ~CreationScope() { creationTarget = previous; }
+    };
+
+    size_t Size() const { return positions.size(); }
+
+    // Makes room for count slots in total. Grows at least geometrically, so reserving for many small
+    // batches in a row stays linear.
+    void Reserve(size_t count);
+    size_t Allocate(Sprite* owner, Vector2 position, Vector2 size, float rotation, Vector2 velocity, ShapeType shape, bool isCollidable);
+    void Release(size_t slot);
+    // Moves sprite's slot here from whichever store holds it, keeping its state
+    void Adopt(Sprite& sprite);
+
+    // Called at the start of every tick and after anything that teleports entities (loading)
+    void SavePreviousState();
+    // Local transform blended between the previous and the current tick. A move of at least the
+    // entity's own size (wrap-around, respawn) snaps instead of sweeping across the screen.
+    Vector2 InterpolatePosition(size_t slot, float alpha) const;
+    float InterpolateRotation(size_t slot, float alpha) const;
+
+    SimdLevel GetSimdLevel() const { return simdLevel; }
+    void SetSimdLevel(SimdLevel level) { simdLevel = level; }
+
+    // Integrates every entity, reflects collidable ones off the screen edges and appends the
+    // slots that hit one. parentOffsets must already hold post-integration parent positions.
+    void Step(float deltaTime, int screenWidth, int screenHeight, std::vector<size_t>& hits);
+    // Same for slots [begin, end) only, so disjoint ranges can be stepped on different threads
+    void StepRange(size_t begin, size_t end, float deltaTime, int screenWidth, int screenHeight, std::vector<size_t>& hits);
+};
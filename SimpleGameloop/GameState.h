@@ -2,52 +2,196 @@
 #include "SceneNode.h"
 #include <vector>
 #include <memory>
-#include <fstream>
 #include "Quadtree.h"
+#include "SweepAndPrune.h"
+#include "SpatialHashGrid.h"
+#include "JobSystem.h"
+#include "SlotMap.h"
+#include "MappedFile.h"
+#include "InputState.h"
+#include "RewindBuffer.h"
+#include "Snapshot.h"
+#include "SnapshotWriter.h"
+#include "SpriteFactory.h"
+#include "RenderQueue.h"
 #include <numbers>
 #include <iostream>
+#include <chrono>
 
 const double M_PI = std::numbers::pi_v<double>;
 
+// Wall-clock cost of each phase of the last GameState::Update, in milliseconds
+struct UpdateTimings {
+    double broadPhaseUpdate = 0.0;
+    double broadPhase = 0.0;
+    double narrowPhase = 0.0;
+    double spriteUpdate = 0.0;
+
+    double Total() const { return broadPhaseUpdate + broadPhase + narrowPhase + spriteUpdate; }
+};
+
 class GameState {
 private:
+    static const size_t PAIR_GRAIN = 512;
+    static const size_t ENTITY_GRAIN = 2048;
+    // The broad phase holds bounds from the start of the last tick, unrotated. Draw widens its
+    // viewport query by this much to cover a tick of motion and the corners of rotated sprites.
+    static constexpr float CULL_MARGIN = 128.0f;
+
+    enum class ContactType {
+        CircleCircle,
+        CircleRect,
+        RectCircle,
+        RectRect
+    };
+
+    // Narrow-phase hit found by a worker, applied on the main thread in order of the two handles
+    struct Contact {
+        uint64_t order;
+        size_t pairIndex;
+        ContactType type;
+    };
+
     ResourceManager& resourceManager;
     Rectangle worldBounds;
-    std::unordered_map<int, std::shared_ptr<SceneNode>> sceneNodeMap;
-    int nextId = 0;
-    Quadtree quadtree;
+    // Sprites of this GameState's nodes only; destroyed after sceneNodes, so they release their slots first
+    EntityStore entities;
+    SlotMap<std::shared_ptr<SceneNode>> sceneNodes; // Every node, roots and children alike
+    std::unique_ptr<BroadPhase> broadPhase;
+    std::vector<std::pair<SceneNode*, SceneNode*>> candidatePairs;
+    std::vector<size_t> wallHits;
+    UpdateTimings timings;
+    JobSystem jobs;
+    std::vector<std::vector<Contact>> threadContacts;
+    std::vector<std::vector<size_t>> threadWallHits;
+    RenderQueue renderQueue;
+    RenderStats renderStats;
+    std::vector<SceneNode*> visibleNodes;
+    std::vector<SceneNode*> alwaysVisibleNodes;
+    bool sceneChanged = true; // Nodes were added, removed or moved since Draw last refreshed the broad phase
+    uint32_t drawCount = 0;   // Tells SceneNode which interpolated positions are from this draw
+    std::vector<Contact> contacts;
+
+    static double LapMilliseconds(std::chrono::steady_clock::time_point& lapStart) {
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double, std::milli>(now - lapStart).count();
+        lapStart = now;
+        return elapsed;
+    }
 
-public:
-    GameState(ResourceManager& resourceManager, Rectangle worldBounds)
-        : resourceManager(resourceManager), worldBounds(worldBounds), quadtree(worldBounds) {}
-
-    int RegisterEntity(std::shared_ptr<SceneNode> node, int parentId = -1) {
-        int id = nextId++;
-        if (parentId == -1)
-            sceneNodeMap[id] = std::move(node);
-        else {
-            auto parentIt = sceneNodeMap.find(parentId);
-            if (parentIt == sceneNodeMap.end()) throw std::runtime_error("Parent ID not found.");
-            parentIt->second->AttachChild(std::move(node));
+    // Builds the whole new scene first, so a bad snapshot throws and leaves the current one intact
+    // Entities keep their saved handles. Handles the current scene handed out stay dead as well.
+    void RestoreRecords(std::span<const EntityRecord> records, const SnapshotStringTable& strings, uint32_t nextGeneration) {
+        SlotMap<std::shared_ptr<SceneNode>> restoredNodes;
+        restoredNodes.Reserve(records.size());
+        std::vector<SceneNode*> nodesByRecord;
+        nodesByRecord.reserve(records.size());
+
+        // The current scene's sprites are still alive, so the store briefly holds both scenes
+        entities.Reserve(entities.Size() + records.size());
+        EntityStore::CreationScope scope(entities);
+        for (const EntityRecord& record : records) {
+            auto node = SceneNode::FromRecord(record, strings, resourceManager);
+            nodesByRecord.push_back(node.get());
+
+            if (record.parent != -1) nodesByRecord[record.parent]->AttachChild(node);
+            EntityHandle handle = node->handle;
+            restoredNodes.InsertAt(handle, std::move(node));
+        }
+        restoredNodes.FinishRestore(std::max(nextGeneration, sceneNodes.GetNextGeneration()));
+
+        broadPhase->Clear();
+        sceneNodes = std::move(restoredNodes);
+        sceneChanged = true;
+        entities.SavePreviousState();
+    }
+
+    SceneNode* FindParent(EntityHandle parent) const {
+        if (!parent.IsValid()) return nullptr;
+        const std::shared_ptr<SceneNode>* found = sceneNodes.Get(parent);
+        if (!found) throw std::runtime_error("Parent entity not found.");
+        return found->get();
+    }
+
+    void AssignHandles(const std::shared_ptr<SceneNode>& node) {
+        node->handle = sceneNodes.Insert(node);
+        node->MoveSpriteTo(entities);
+        for (const auto& child : node->GetChildren()) AssignHandles(child);
+    }
+
+    static std::unique_ptr<BroadPhase> CreateBroadPhase(BroadPhaseType type, Rectangle worldBounds) {
+        switch (type) {
+        case BroadPhaseType::SweepAndPrune:
+            return std::make_unique<SweepAndPrune>();
+        case BroadPhaseType::SpatialHash:
+            return std::make_unique<SpatialHashGrid>();
+        case BroadPhaseType::Quadtree:
+        default:
+            return std::make_unique<Quadtree>(worldBounds);
         }
-        return id;
     }
 
-    std::shared_ptr<SceneNode> GetEntityById(int id) {
-        auto it = sceneNodeMap.find(id);
-        if (it != sceneNodeMap.end())
-            return it->second;
-        return nullptr;
+public:
+    // workerThreads extra threads join the main one for the narrow phase and the entity update
+    GameState(ResourceManager& resourceManager, Rectangle worldBounds, BroadPhaseType broadPhaseType = BroadPhaseType::Quadtree,
+        size_t workerThreads = JobSystem::DefaultWorkerCount())
+        : GameState(resourceManager, worldBounds, CreateBroadPhase(broadPhaseType, worldBounds), workerThreads) {}
+
+    // For a broad phase that needs tuning, e.g. a SpatialHashGrid with a scene-specific cell size
+    GameState(ResourceManager& resourceManager, Rectangle worldBounds, std::unique_ptr<BroadPhase> broadPhase,
+        size_t workerThreads = JobSystem::DefaultWorkerCount())
+        : resourceManager(resourceManager), worldBounds(worldBounds), broadPhase(std::move(broadPhase)), jobs(workerThreads),
+        threadContacts(jobs.GetThreadCount()), threadWallHits(jobs.GetThreadCount()) {}
+
+    // Registers node and everything already attached below it. Every one of them gets a handle,
+    // which is stored in SceneNode::handle; the returned one is node's own.
+    EntityHandle RegisterEntity(std::shared_ptr<SceneNode> node, EntityHandle parent = {}) {
+        SceneNode* parentNode = FindParent(parent);
+        AssignHandles(node);
+        if (parentNode) parentNode->AttachChild(node);
+        sceneChanged = true;
+        return node->handle;
     }
 
-    void RemoveEntity(int id) {
-        auto node = GetEntityById(id);
-        if (node) {
-            if (node->parent)
-                node->parent->DetachChild(*node);
-            else
-                sceneNodeMap.erase(id);
+    // Creates and registers a whole batch at once, under parent if one is given. Returns the new
+    // handles in spawn order.
+    std::vector<EntityHandle> Spawn(const SpawnDescriptor& descriptor, EntityHandle parent = {}) {
+        SceneNode* parentNode = FindParent(parent);
+        std::vector<std::shared_ptr<SceneNode>> nodes;
+        SpriteFactory::Spawn(descriptor, resourceManager, entities, nodes);
+
+        std::vector<EntityHandle> handles;
+        handles.reserve(nodes.size());
+        sceneNodes.Reserve(sceneNodes.Size() + nodes.size());
+        for (auto& node : nodes) {
+            node->handle = sceneNodes.Insert(node);
+            handles.push_back(node->handle);
+            if (parentNode) parentNode->AttachChild(std::move(node));
         }
+        sceneChanged = true;
+        return handles;
+    }
+
+    // For building nodes with SpriteFactory::Spawn that are registered right after, e.g. with children
+    // attached first, so their sprites need not move stores
+    EntityStore& GetEntityStore() {
+        return entities;
+    }
+
+    // Null for handles of removed entities
+    std::shared_ptr<SceneNode> GetEntity(EntityHandle handle) const {
+        const std::shared_ptr<SceneNode>* found = sceneNodes.Get(handle);
+        return found ? *found : nullptr;
+    }
+
+    // Removes the entity together with its subtree
+    void RemoveEntity(EntityHandle handle) {
+        auto node = GetEntity(handle);
+        if (!node) return;
+
+        RemoveNodeRecursively(*node);
+        if (node->parent) node->parent->DetachChild(*node);
+        sceneChanged = true;
     }
 
     void MoveNode(SceneNode& nodeToMove, SceneNode& newParent) {
@@ -55,57 +199,145 @@ public:
             throw std::runtime_error("Node to move has no parent and cannot be moved.");
 
         std::shared_ptr<SceneNode> detachedNode = nodeToMove.parent->DetachChild(nodeToMove);
+        sceneChanged = true;
         newParent.AttachChild(std::move(detachedNode));
     }
 
-    void InsertNodeRecursively(std::shared_ptr<SceneNode> node) {
-        quadtree.Insert(node);
-
-        for (const auto& child : node->GetChildren()) InsertNodeRecursively(child);
-    }
-
-    void Update(float deltaTime, int screenWidth, int screenHeight) {
-        quadtree.Clear();
-        for (auto& [id, node] : sceneNodeMap)
-            InsertNodeRecursively(node);
-
-        for (auto& node : quadtree.Retrieve(Rectangle{ 0, 0, (float)screenWidth, (float)screenHeight })) {
-            Rectangle bounds = node->GetBounds();
-            auto nearbyNodes = quadtree.Retrieve(bounds);
-
-            for (const auto& nearbyNode : nearbyNodes) {
-                if (node != nearbyNode && node->IsCollidable() && nearbyNode->IsCollidable()) {
-                    Vector2 pos1 = node->GetGlobalPosition();
-                    Vector2 pos2 = nearbyNode->GetGlobalPosition();
-                    Vector2 size1 = node->GetSize();
-                    Vector2 size2 = nearbyNode->GetSize();
-
-                    if (node->GetShape() == ShapeType::Circular) {
-                        if (nearbyNode->GetShape() == ShapeType::Circular &&
-                            CheckCollisionCircles(pos1, size1.x / 2, pos2, size2.x / 2)) {
-                            HandleCircularCollision(*node, *nearbyNode);
-                        }
-                        else if (nearbyNode->GetShape() == ShapeType::Rectangular &&
-                            CheckCollisionCircleRec(pos1, size1.x / 2, nearbyNode->GetBounds())) {
-                            HandleCircleRectCollision(*node, *nearbyNode);
-                        }
-                    }
-                    else if (node->GetShape() == ShapeType::Rectangular) {
-                        if (nearbyNode->GetShape() == ShapeType::Circular &&
-                            CheckCollisionCircleRec(pos2, size2.x / 2, bounds)) {
-                            HandleCircleRectCollision(*nearbyNode, *node);
-                        }
-                        else if (nearbyNode->GetShape() == ShapeType::Rectangular &&
-                            CheckCollisionRecs(nearbyNode->GetBounds(), bounds)) {
-                            HandleRectangularCollision(*node, *nearbyNode);
-                        }
-                    }
+    void RemoveNodeRecursively(SceneNode& node) {
+        broadPhase->Remove(node);
+        sceneNodes.Remove(node.handle);
+        node.handle = {};
+        // The caller may still hold the node; it should not be stepped with this scene any more
+        node.MoveSpriteTo(EntityStore::Unattached());
+
+        for (const auto& child : node.GetChildren()) RemoveNodeRecursively(*child);
+    }
+
+    // input is what every sprite sees this tick; the default is no buttons and the mouse at the origin
+    void Update(float deltaTime, int screenWidth, int screenHeight, const InputState& input = {}) {
+        auto phaseStart = std::chrono::steady_clock::now();
+        entities.SavePreviousState();
+
+        for (const auto& node : sceneNodes)
+            broadPhase->Update(node);
+        timings.broadPhaseUpdate = LapMilliseconds(phaseStart);
+
+        candidatePairs.clear();
+        broadPhase->CollectPairs(candidatePairs);
+        timings.broadPhase = LapMilliseconds(phaseStart);
+
+        // Tests only read world transforms, which the broad-phase pass above has just refreshed.
+        // Responses change velocities, so they are applied serially. Each pair is turned to put the
+        // lower handle first and contacts run in handle order, which makes the outcome independent
+        // of the broad phase, the thread count and the order entities were stored in.
+        for (auto& threadList : threadContacts) threadList.clear();
+        jobs.ParallelFor(candidatePairs.size(), PAIR_GRAIN, [this](size_t begin, size_t end, size_t thread) {
+            ContactType type;
+            for (size_t i = begin; i < end; ++i) {
+                auto& [first, second] = candidatePairs[i];
+                if (second->handle.index < first->handle.index) std::swap(first, second);
+                if (DetectCollision(*first, *second, type)) {
+                    uint64_t order = static_cast<uint64_t>(first->handle.index) << 32 | second->handle.index;
+                    threadContacts[thread].push_back({ order, i, type });
                 }
             }
-            node->Update(deltaTime, screenWidth, screenHeight);
+        });
+
+        contacts.clear();
+        for (const auto& threadList : threadContacts) contacts.insert(contacts.end(), threadList.begin(), threadList.end());
+        std::sort(contacts.begin(), contacts.end(), [](const Contact& a, const Contact& b) { return a.order < b.order; });
+        for (const Contact& contact : contacts)
+            ApplyCollisionResponse(*candidatePairs[contact.pairIndex].first, *candidatePairs[contact.pairIndex].second, contact.type);
+        timings.narrowPhase = LapMilliseconds(phaseStart);
+
+        // Sprite behaviour only touches the sprite's own slot, so it runs straight off the store
+        jobs.ParallelFor(entities.Size(), ENTITY_GRAIN, [this, &input, deltaTime, screenWidth, screenHeight](size_t begin, size_t end, size_t) {
+            for (size_t slot = begin; slot < end; ++slot) entities.owners[slot]->Update(deltaTime, screenWidth, screenHeight, input);
+        });
+
+        for (const auto& node : sceneNodes)
+            if (!node->parent) node->PropagateParentOffsets({ 0, 0 }, deltaTime, screenWidth, screenHeight);
+
+        for (auto& threadList : threadWallHits) threadList.clear();
+        jobs.ParallelFor(entities.Size(), ENTITY_GRAIN, [this, deltaTime, screenWidth, screenHeight](size_t begin, size_t end, size_t thread) {
+            entities.StepRange(begin, end, deltaTime, screenWidth, screenHeight, threadWallHits[thread]);
+        });
+
+        // Sounds are played on the main thread in slot order
+        wallHits.clear();
+        for (const auto& threadList : threadWallHits) wallHits.insert(wallHits.end(), threadList.begin(), threadList.end());
+        std::sort(wallHits.begin(), wallHits.end());
+        for (size_t slot : wallHits) entities.owners[slot]->OnCollision();
+
+        for (const auto& node : sceneNodes)
+            if (!node->parent) node->UpdateWorldTransform();
+        timings.spriteUpdate = LapMilliseconds(phaseStart);
+    }
+
+    const UpdateTimings& GetLastTimings() const {
+        return timings;
+    }
+
+    size_t GetEntityCount() const {
+        return sceneNodes.Size();
+    }
+
+    bool DetectCollision(const SceneNode& node, const SceneNode& nearbyNode, ContactType& type) const {
+        Rectangle bounds = node.GetBounds();
+        Vector2 pos1 = node.GetGlobalPosition();
+        Vector2 pos2 = nearbyNode.GetGlobalPosition();
+        Vector2 size1 = node.GetSize();
+        Vector2 size2 = nearbyNode.GetSize();
+
+        if (node.GetShape() == ShapeType::Circular) {
+            if (nearbyNode.GetShape() == ShapeType::Circular &&
+                CheckCollisionCircles(pos1, size1.x / 2, pos2, size2.x / 2)) {
+                type = ContactType::CircleCircle;
+                return true;
+            }
+            else if (nearbyNode.GetShape() == ShapeType::Rectangular &&
+                CheckCollisionCircleRec(pos1, size1.x / 2, nearbyNode.GetBounds())) {
+                type = ContactType::CircleRect;
+                return true;
+            }
+        }
+        else if (node.GetShape() == ShapeType::Rectangular) {
+            if (nearbyNode.GetShape() == ShapeType::Circular &&
+                CheckCollisionCircleRec(pos2, size2.x / 2, bounds)) {
+                type = ContactType::RectCircle;
+                return true;
+            }
+            else if (nearbyNode.GetShape() == ShapeType::Rectangular &&
+                CheckCollisionRecs(nearbyNode.GetBounds(), bounds)) {
+                type = ContactType::RectRect;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ApplyCollisionResponse(SceneNode& node, SceneNode& nearbyNode, ContactType type) {
+        switch (type) {
+        case ContactType::CircleCircle:
+            HandleCircularCollision(node, nearbyNode);
+            break;
+        case ContactType::CircleRect:
+            HandleCircleRectCollision(node, nearbyNode);
+            break;
+        case ContactType::RectCircle:
+            HandleCircleRectCollision(nearbyNode, node);
+            break;
+        case ContactType::RectRect:
+            HandleRectangularCollision(node, nearbyNode);
+            break;
         }
     }
 
+    void ResolveCollision(SceneNode& node, SceneNode& nearbyNode) {
+        ContactType type;
+        if (DetectCollision(node, nearbyNode, type)) ApplyCollisionResponse(node, nearbyNode, type);
+    }
+
     void HandleCircularCollision(SceneNode& node1, SceneNode& node2) {
         Vector2 direction = { node2.GetGlobalPosition().x - node1.GetGlobalPosition().x,
                              node2.GetGlobalPosition().y - node1.GetGlobalPosition().y };
@@ -138,73 +370,122 @@ public:
         return { magnitude * cos(angle), magnitude * sin(angle) };
     }
 
-    void Draw() const {
-        for (const auto& [id, node] : sceneNodeMap)
-            node->Draw();
+    // alpha is SimulationClock::GetAlpha(): how far the frame is past the last tick
+    // Only nodes the broad phase finds in viewport are drawn, sorted by layer and then texture
+    void Draw(float alpha, const Rectangle& viewport) {
+        PrepareDraw(alpha, viewport);
+        renderQueue.Submit();
     }
 
-    void SaveSceneGraph(std::ofstream& sceneFile) const {
-        size_t nodeCount = sceneNodeMap.size();
-        sceneFile.write(reinterpret_cast<const char*>(&nodeCount), sizeof(nodeCount));
-
-        for (const auto& [id, node] : sceneNodeMap) {
-            sceneFile.write(reinterpret_cast<const char*>(&id), sizeof(id));
-            node->SaveScene(sceneFile);
+    // Everything Draw does short of submitting to the GPU, so it can run without a window.
+    // Fills GetLastRenderStats().
+    void PrepareDraw(float alpha, const Rectangle& viewport) {
+        if (sceneChanged) {
+            alwaysVisibleNodes.clear();
+            for (const auto& node : sceneNodes) {
+                broadPhase->Update(node);
+                if (node->IsAlwaysVisible()) alwaysVisibleNodes.push_back(node.get());
+            }
+            sceneChanged = false;
         }
+
+        drawCount++;
+        visibleNodes.clear();
+        broadPhase->Retrieve({ viewport.x - CULL_MARGIN, viewport.y - CULL_MARGIN,
+            viewport.width + 2 * CULL_MARGIN, viewport.height + 2 * CULL_MARGIN }, visibleNodes);
+
+        // The query is conservative; the queue drops what turns out to be off screen
+        renderQueue.Begin(viewport);
+        renderStats.visibleNodes = 0;
+        auto queueNode = [&](SceneNode* node) {
+            size_t queued = renderQueue.Size();
+            node->QueueDraw(renderQueue, alpha, drawCount);
+            if (renderQueue.Size() > queued) renderStats.visibleNodes++;
+        };
+        for (SceneNode* node : alwaysVisibleNodes) queueNode(node);
+        for (SceneNode* node : visibleNodes)
+            if (!node->IsAlwaysVisible()) queueNode(node);
+
+        renderStats.batches = renderQueue.Sort();
+        renderStats.quads = renderQueue.Size();
     }
 
-    void LoadSceneGraph(std::ifstream& sceneFile) {
-        size_t nodeCount;
-        sceneFile.read(reinterpret_cast<char*>(&nodeCount), sizeof(nodeCount));
+    const RenderStats& GetLastRenderStats() const {
+        return renderStats;
+    }
 
-        sceneNodeMap.clear();
-        for (size_t i = 0; i < nodeCount; ++i) {
-            int id;
-            sceneFile.read(reinterpret_cast<char*>(&id), sizeof(id));
+    // Roots in slot map order, each followed by its subtree. A restore recreates them in exactly
+    // that order, so saving again gives the same bytes.
+    void CaptureSnapshot(SnapshotData& snapshot) const {
+        snapshot.Clear();
+        snapshot.records.reserve(sceneNodes.Size());
+        snapshot.nextGeneration = sceneNodes.GetNextGeneration();
+        for (const auto& node : sceneNodes)
+            if (!node->parent) node->SaveSnapshot(snapshot, -1);
+    }
 
-            auto node = std::make_shared<SceneNode>(resourceManager);
-            node->LoadScene(sceneFile);
-            sceneNodeMap[id] = std::move(node);
-        }
+    void RestoreSnapshot(const SnapshotData& snapshot) {
+        RestoreRecords(snapshot.records, snapshot.strings, snapshot.nextGeneration);
     }
 
-    void SaveSprites(std::ofstream& spriteFile) const {
-        for (const auto& [id, node] : sceneNodeMap) node->SaveSprite(spriteFile);
+    void RestoreSnapshot(const SnapshotView& view) {
+        RestoreRecords(view.records, view.strings, view.nextGeneration);
     }
 
-    void LoadSprites(std::ifstream& spriteFile) {
-        for (auto& [id, node] : sceneNodeMap) node->LoadSprite(spriteFile);
+    void SaveGameState(const std::string& filePath) const {
+        SnapshotData snapshot;
+        CaptureSnapshot(snapshot);
+
+        std::vector<uint8_t> buffer;
+        Snapshot::Encode(snapshot, buffer);
+        Snapshot::WriteFile(filePath, buffer);
     }
 
-    void SaveGameState(const std::string& sceneFilePath, const std::string& spriteFilePath) const {
-        std::ofstream sceneFile(sceneFilePath, std::ios::binary);
-        if (!sceneFile.is_open()) throw std::runtime_error("Failed to open scene file for saving.");
-        SaveSceneGraph(sceneFile);
-        sceneFile.close();
+    // Checksum of the encoded scene, for telling whether two runs ended in exactly the same state
+    uint32_t ComputeStateChecksum() const {
+        SnapshotData snapshot;
+        CaptureSnapshot(snapshot);
 
-        std::ofstream spriteFile(spriteFilePath, std::ios::binary);
-        if (!spriteFile.is_open()) throw std::runtime_error("Failed to open sprite file for saving.");
-        SaveSprites(spriteFile);
-        spriteFile.close();
+        std::vector<uint8_t> buffer;
+        Snapshot::Encode(snapshot, buffer);
+        return Snapshot::Checksum(buffer.data(), buffer.size());
     }
 
-    void LoadGameState(const std::string& sceneFilePath, const std::string& spriteFilePath) {
-        std::unordered_map<int, std::shared_ptr<SceneNode>> previousState = sceneNodeMap;
+    // Call after every tick that should be reachable by RewindTo
+    void RecordRewindFrame(RewindBuffer& rewind, uint64_t tick) const {
+        CaptureSnapshot(rewind.GetCaptureBuffer());
+        rewind.Record(tick);
+    }
+
+    // Restores the scene as it was after tick and forgets everything recorded later. Returns false
+    // and leaves the scene alone if that tick is no longer in the buffer.
+    bool RewindTo(RewindBuffer& rewind, uint64_t tick) {
+        const SnapshotData* snapshot = rewind.Rewind(tick);
+        if (!snapshot) return false;
+
+        RestoreSnapshot(*snapshot);
+        return true;
+    }
+
+    // Captures the scene now, at the tick boundary, and leaves encoding and writing to the writer's
+    // thread. Returns false if the writer is still busy with the previous save.
+    bool SaveGameStateAsync(SnapshotWriter& writer, const std::string& filePath) const {
+        if (writer.IsBusy()) return false;
+
+        CaptureSnapshot(writer.GetCaptureBuffer());
+        return writer.Submit(filePath);
+    }
 
+    void LoadGameState(const std::string& filePath) {
         try {
-            std::ifstream sceneFile(sceneFilePath, std::ios::binary);
-            if (!sceneFile.is_open()) throw std::runtime_error("Failed to open scene file for loading.");
-            LoadSceneGraph(sceneFile);
-            sceneFile.close();
-
-            std::ifstream spriteFile(spriteFilePath, std::ios::binary);
-            if (!spriteFile.is_open()) throw std::runtime_error("Failed to open sprite file for loading.");
-            LoadSprites(spriteFile);
-            spriteFile.close();
+            // Records are read straight out of the mapping, which only has to outlive the restore
+            MappedFile file(filePath);
+            SnapshotView view;
+            Snapshot::Decode(file.Data(), file.Size(), view);
+            RestoreSnapshot(view);
         }
         catch (const std::exception& e) {
             std::cerr << "Error loading game state: " << e.what() << std::endl;
-            sceneNodeMap = previousState;
         }
     }
 
@@ -0,0 +1,128 @@
+#include "InputRecording.h"
+#include "BinaryIO.h"
+#include "MappedFile.h"
+#include <bit>
+
+namespace {
+    enum InputField : uint32_t {
+        Buttons = 1u << 0,
+        MouseX = 1u << 1,
+        MouseY = 1u << 2,
+        WheelX = 1u << 3,
+        WheelY = 1u << 4,
+        AllFields = (1u << 5) - 1
+    };
+
+    // Field order matches the InputField bits
+    void GetFields(const InputState& input, uint32_t fields[5]) {
+        fields[0] = input.buttons;
+        fields[1] = std::bit_cast<uint32_t>(input.mousePosition.x);
+        fields[2] = std::bit_cast<uint32_t>(input.mousePosition.y);
+        fields[3] = std::bit_cast<uint32_t>(input.wheelMove.x);
+        fields[4] = std::bit_cast<uint32_t>(input.wheelMove.y);
+    }
+
+    InputState SetFields(const uint32_t fields[5]) {
+        InputState input;
+        input.buttons = fields[0];
+        input.mousePosition = { std::bit_cast<float>(fields[1]), std::bit_cast<float>(fields[2]) };
+        input.wheelMove = { std::bit_cast<float>(fields[3]), std::bit_cast<float>(fields[4]) };
+        return input;
+    }
+}
+
+InputRecording::InputRecording(float tickRate, int screenWidth, int screenHeight, const SnapshotData& startState)
+    : tickRate(tickRate), screenWidth(screenWidth), screenHeight(screenHeight) {
+    Snapshot::Encode(startState, startSnapshot);
+}
+
+void InputRecording::DecodeStartState(SnapshotData& snapshot) const {
+    Snapshot::Decode(startSnapshot.data(), startSnapshot.size(), snapshot);
+}
+
+void InputRecording::Save(const std::string& path) const {
+    std::vector<uint8_t> input;
+    uint32_t previous[5] = {};
+    size_t tick = 0;
+    while (tick < ticks.size()) {
+        size_t runEnd = tick + 1;
+        while (runEnd < ticks.size() && std::memcmp(&ticks[runEnd], &ticks[tick], sizeof(InputState)) == 0) ++runEnd;
+
+        uint32_t fields[5];
+        GetFields(ticks[tick], fields);
+        uint32_t mask = 0;
+        for (int field = 0; field < 5; ++field)
+            if (fields[field] != previous[field]) mask |= 1u << field;
+
+        PutVarint(input, static_cast<uint32_t>(runEnd - tick));
+        PutVarint(input, mask);
+        for (int field = 0; field < 5; ++field)
+            if (mask & (1u << field)) PutVarint(input, fields[field] ^ previous[field]);
+
+        std::memcpy(previous, fields, sizeof(fields));
+        tick = runEnd;
+    }
+
+    std::vector<uint8_t> buffer(HEADER_SIZE + startSnapshot.size() + input.size());
+    uint8_t* header = buffer.data();
+    std::memcpy(header + HEADER_SIZE, startSnapshot.data(), startSnapshot.size());
+    if (!input.empty()) std::memcpy(header + HEADER_SIZE + startSnapshot.size(), input.data(), input.size());
+
+    PutWord(header + 0, MAGIC);
+    PutWord(header + 4, VERSION);
+    PutWord(header + 8, HEADER_SIZE);
+    PutWord(header + 12, std::bit_cast<uint32_t>(tickRate));
+    PutWord(header + 16, static_cast<uint32_t>(screenWidth));
+    PutWord(header + 20, static_cast<uint32_t>(screenHeight));
+    PutWord(header + 24, static_cast<uint32_t>(ticks.size()));
+    PutWord(header + 28, static_cast<uint32_t>(startSnapshot.size()));
+    PutWord(header + 32, static_cast<uint32_t>(input.size()));
+    PutWord(header + 36, Snapshot::Checksum(header + HEADER_SIZE, buffer.size() - HEADER_SIZE));
+
+    Snapshot::WriteFile(path, buffer);
+}
+
+InputRecording InputRecording::Load(const std::string& path) {
+    MappedFile file(path);
+    const uint8_t* data = file.Data();
+    size_t size = file.Size();
+
+    if (size < HEADER_SIZE || GetWord(data) != MAGIC) throw std::runtime_error("Not an input recording");
+    if (GetWord(data + 4) != VERSION) throw std::runtime_error("Unsupported input recording version " + std::to_string(GetWord(data + 4)));
+
+    uint64_t snapshotBytes = GetWord(data + 28);
+    uint64_t inputBytes = GetWord(data + 32);
+    if (GetWord(data + 8) != HEADER_SIZE || HEADER_SIZE + snapshotBytes + inputBytes != size)
+        throw std::runtime_error("Input recording sections do not match the file size");
+    if (Snapshot::Checksum(data + HEADER_SIZE, size - HEADER_SIZE) != GetWord(data + 36))
+        throw std::runtime_error("Input recording checksum mismatch");
+
+    InputRecording recording;
+    recording.tickRate = std::bit_cast<float>(GetWord(data + 12));
+    recording.screenWidth = static_cast<int32_t>(GetWord(data + 16));
+    recording.screenHeight = static_cast<int32_t>(GetWord(data + 20));
+    if (!(recording.tickRate > 0.0f) || recording.screenWidth <= 0 || recording.screenHeight <= 0)
+        throw std::runtime_error("Input recording has an invalid tick rate or screen size");
+
+    const uint8_t* snapshot = data + HEADER_SIZE;
+    recording.startSnapshot.assign(snapshot, snapshot + snapshotBytes);
+
+    uint32_t tickCount = GetWord(data + 24);
+    recording.ticks.reserve(tickCount);
+    uint32_t fields[5] = {};
+    const uint8_t* cursor = snapshot + snapshotBytes;
+    const uint8_t* end = data + size;
+    while (cursor != end) {
+        uint32_t runLength = GetVarint(cursor, end);
+        uint32_t mask = GetVarint(cursor, end);
+        if (runLength == 0 || runLength > tickCount - recording.ticks.size() || (mask & ~AllFields))
+            throw std::runtime_error("Input recording is corrupt");
+
+        for (int field = 0; field < 5; ++field)
+            if (mask & (1u << field)) fields[field] ^= GetVarint(cursor, end);
+        recording.ticks.insert(recording.ticks.end(), runLength, SetFields(fields));
+    }
+    if (recording.ticks.size() != tickCount) throw std::runtime_error("Input recording is truncated");
+
+    return recording;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "InputState.h"
+#include "Snapshot.h"
+
+// A recorded session: the scene before its first tick and the input of every tick after it.
+// Replaying it on a fresh GameState at the same tick rate and screen size gives the same end state
+// every time, so it doubles as a reproducible workload for benchmarks.
+//
+// File, all little-endian:
+//   header    10 words: magic, version, header size, tick rate (float bits), screen width, screen
+//             height, tick count, snapshot bytes, input bytes, checksum of everything after the header
+//   snapshot  the start scene as an encoded Snapshot
+//   input     runs of identical ticks: varint run length, varint mask of the fields that changed
+//             since the previous run, then each changed field as a varint (float bits XORed with
+//             the previous value)
+class InputRecording {
+public:
+    static const uint32_t MAGIC = 0x494C4753; // "SGLI"
+    static const uint32_t VERSION = 1;
+    static const uint32_t HEADER_SIZE = 40;
+
+    InputRecording() = default;
+    InputRecording(float tickRate, int screenWidth, int screenHeight, const SnapshotData& startState);
+
+    void Add(const InputState& input) { ticks.push_back(input); }
+
+    float GetTickRate() const { return tickRate; }
+    int GetScreenWidth() const { return screenWidth; }
+    int GetScreenHeight() const { return screenHeight; }
+    size_t GetTickCount() const { return ticks.size(); }
+    const InputState& GetInput(size_t tick) const { return ticks[tick]; }
+    void DecodeStartState(SnapshotData& snapshot) const;
+
+    // Written through Snapshot::WriteFile, so an interrupted save keeps the previous file
+    void Save(const std::string& path) const;
+    // Throws std::runtime_error for anything that is not an intact recording of this version
+    static InputRecording Load(const std::string& path);
+
+private:
+    float tickRate = 0.0f;
+    int32_t screenWidth = 0;
+    int32_t screenHeight = 0;
+    std::vector<uint8_t> startSnapshot;
+    std::vector<InputState> ticks;
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include "raylib.h"
+#include <cstdint>
+
+// Everything sprites read from the player during one tick. main() polls it once per frame and
+// passes it down through GameState::Update, so a recorded run can feed the exact same values back.
+struct InputState {
+    enum Button : uint32_t {
+        MoveUp = 1u << 0,
+        MoveDown = 1u << 1,
+        MoveLeft = 1u << 2,
+        MoveRight = 1u << 3
+    };
+
+    uint32_t buttons = 0;
+    Vector2 mousePosition = { 0, 0 };
+    Vector2 wheelMove = { 0, 0 }; // Movement since the previous tick, not since the previous frame
+
+    bool IsDown(Button button) const { return (buttons & button) != 0; }
+
+    static InputState Poll() {
+        InputState input;
+        if (IsKeyDown(KEY_W)) input.buttons |= MoveUp;
+        if (IsKeyDown(KEY_S)) input.buttons |= MoveDown;
+        if (IsKeyDown(KEY_A)) input.buttons |= MoveLeft;
+        if (IsKeyDown(KEY_D)) input.buttons |= MoveRight;
+        input.mousePosition = GetMousePosition();
+        input.wheelMove = GetMouseWheelMoveV();
+        return input;
+    }
+};
@@ -0,0 +1,93 @@
+#include "JobSystem.h"
+#include <algorithm>
+
+JobSystem::JobSystem(size_t workerCount) {
+    for (size_t i = 0; i < workerCount + 1; ++i) queues.push_back(std::make_unique<WorkQueue>());
+    for (size_t i = 1; i <= workerCount; ++i) workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+size_t JobSystem::DefaultWorkerCount() {
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+void JobSystem::ParallelFor(size_t count, size_t grainSize, const RangeJob& body) {
+    if (count == 0) return;
+    grainSize = std::max<size_t>(grainSize, 1);
+
+    if (workers.empty() || count <= grainSize) {
+        body(0, count, 0);
+        return;
+    }
+
+    size_t chunkCount = (count + grainSize - 1) / grainSize;
+    unfinishedJobs += chunkCount;
+
+    // Deal chunks round-robin so every thread starts with local work before it has to steal
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        size_t begin = chunk * grainSize;
+        WorkQueue& queue = *queues[chunk % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back({ &body, begin, std::min(begin + grainSize, count) });
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queuedJobs += chunkCount;
+    }
+    wake.notify_all();
+
+    while (unfinishedJobs.load(std::memory_order_acquire) > 0)
+        if (!RunOneJob(0)) std::this_thread::yield();
+}
+
+bool JobSystem::PopJob(size_t threadIndex, Job& job) {
+    WorkQueue& queue = *queues[threadIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) return false;
+
+    job = queue.jobs.back();
+    queue.jobs.pop_back();
+    return true;
+}
+
+bool JobSystem::StealJob(size_t threadIndex, Job& job) {
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkQueue& queue = *queues[(threadIndex + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty()) continue;
+
+        job = queue.jobs.front();
+        queue.jobs.pop_front();
+        return true;
+    }
+    return false;
+}
+
+bool JobSystem::RunOneJob(size_t threadIndex) {
+    Job job;
+    if (!PopJob(threadIndex, job) && !StealJob(threadIndex, job)) return false;
+
+    --queuedJobs;
+    (*job.body)(job.begin, job.end, threadIndex);
+    unfinishedJobs.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void JobSystem::WorkerLoop(size_t threadIndex) {
+    while (true) {
+        if (RunOneJob(threadIndex)) continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this] { return stopping || queuedJobs.load() > 0; });
+        if (stopping) return;
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads with one deque per thread. The owner pops jobs from the back of
+// its own deque and idle threads steal from the front of the others. The calling thread takes
+// part in every ParallelFor as thread index 0, so a pool with zero workers runs everything inline.
+class JobSystem {
+public:
+    // body(begin, end, threadIndex) with threadIndex in [0, GetThreadCount())
+    using RangeJob = std::function<void(size_t, size_t, size_t)>;
+
+    explicit JobSystem(size_t workerCount = DefaultWorkerCount());
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    ~JobSystem();
+
+    static size_t DefaultWorkerCount();
+    size_t GetThreadCount() const { return queues.size(); }
+
+    // Splits [0, count) into chunks of at most grainSize and blocks until all of them ran
+    void ParallelFor(size_t count, size_t grainSize, const RangeJob& body);
+
+private:
+    struct Job {
+        const RangeJob* body;
+        size_t begin;
+        size_t end;
+    };
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<size_t> queuedJobs = 0;
+    std::atomic<size_t> unfinishedJobs = 0;
+    bool stopping = false;
+
+    bool PopJob(size_t threadIndex, Job& job);
+    bool StealJob(size_t threadIndex, Job& job);
+    bool RunOneJob(size_t threadIndex);
+    void WorkerLoop(size_t threadIndex);
+};
@@ -0,0 +1,90 @@
+#include "MappedFile.h"
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+MappedFile::MappedFile(const std::string& path) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("Failed to open " + path + " for mapping.");
+    fileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        Close();
+        throw std::runtime_error("Failed to get the size of " + path + ".");
+    }
+    if (static_cast<unsigned long long>(fileSize.QuadPart) > SIZE_MAX) {
+        Close();
+        throw std::runtime_error(path + " is too large to map.");
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+    if (size == 0) return;
+
+    mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingHandle) {
+        Close();
+        throw std::runtime_error("Failed to map " + path + ".");
+    }
+
+    data = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (!data) {
+        Close();
+        throw std::runtime_error("Failed to map " + path + ".");
+    }
+}
+
+void MappedFile::Close() {
+    if (data) UnmapViewOfFile(data);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+    data = nullptr;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+    size = 0;
+}
+
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& path) {
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) throw std::runtime_error("Failed to open " + path + " for mapping.");
+
+    struct stat status;
+    if (fstat(file, &status) != 0) {
+        close(file);
+        throw std::runtime_error("Failed to get the size of " + path + ".");
+    }
+    size = static_cast<size_t>(status.st_size);
+    if (size == 0) {
+        close(file);
+        return;
+    }
+
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    // The mapping keeps its own reference to the file
+    close(file);
+    if (mapping == MAP_FAILED) {
+        size = 0;
+        throw std::runtime_error("Failed to map " + path + ".");
+    }
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    data = static_cast<const uint8_t*>(mapping);
+}
+
+void MappedFile::Close() {
+    if (data) munmap(const_cast<uint8_t*>(data), size);
+    data = nullptr;
+    size = 0;
+}
+#endif
+
+MappedFile::~MappedFile() {
+    Close();
+}
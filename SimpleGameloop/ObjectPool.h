@@ -0,0 +1,136 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+struct PoolStats {
+    size_t liveObjects = 0;
+    size_t capacity = 0;      // Blocks in all chunks, live or free
+    size_t allocations = 0;   // Objects handed out since start
+    size_t chunkAllocations = 0; // Trips to the heap since start
+};
+
+// Fixed-size blocks carved out of chunks that double in size. Freed blocks go on an intrusive free
+// list and are handed out again before any new chunk is taken, so once a level has been built,
+// destroying it and building the next one does not touch the heap. Not thread-safe, like EntityStore.
+class BlockPool {
+private:
+    static constexpr size_t FIRST_CHUNK_BLOCKS = 64;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    size_t blockSize;
+    std::vector<std::byte*> chunks;
+    FreeBlock* freeList = nullptr;
+    size_t nextChunkBlocks = FIRST_CHUNK_BLOCKS;
+    PoolStats& stats;
+
+    void AddChunk() {
+        auto* chunk = static_cast<std::byte*>(::operator new(blockSize * nextChunkBlocks));
+        chunks.push_back(chunk);
+        stats.capacity += nextChunkBlocks;
+        stats.chunkAllocations++;
+
+        // Threaded back to front so blocks are handed out in address order
+        for (size_t i = nextChunkBlocks; i > 0; --i) {
+            auto* block = reinterpret_cast<FreeBlock*>(chunk + (i - 1) * blockSize);
+            block->next = freeList;
+            freeList = block;
+        }
+        nextChunkBlocks *= 2;
+    }
+
+public:
+    // Chunks come from plain operator new, so alignment may not exceed what it guarantees
+    BlockPool(size_t size, size_t alignment, PoolStats& stats) : stats(stats) {
+        alignment = std::max(alignment, alignof(FreeBlock));
+        blockSize = (std::max(size, sizeof(FreeBlock)) + alignment - 1) / alignment * alignment;
+    }
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    // Pools live until exit; an object still alive then keeps its chunk rather than dangling
+    ~BlockPool() {
+        if (stats.liveObjects > 0) return;
+        for (std::byte* chunk : chunks) ::operator delete(chunk);
+    }
+
+    void* Allocate() {
+        if (!freeList) AddChunk();
+        FreeBlock* block = freeList;
+        freeList = block->next;
+        stats.liveObjects++;
+        stats.allocations++;
+        return block;
+    }
+
+    void Deallocate(void* pointer) {
+        auto* block = static_cast<FreeBlock*>(pointer);
+        block->next = freeList;
+        freeList = block;
+        stats.liveObjects--;
+    }
+};
+
+// Allocator over one BlockPool per Tag and allocated type. std::allocate_shared rebinds it to its
+// own control block type, so object and reference counts share one pooled block, and every object
+// of one Tag sits in that Tag's chunks.
+template <typename T, typename Tag = T>
+class PoolAllocator {
+private:
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Pooled types must not be over-aligned");
+
+    static BlockPool& Pool() {
+        static BlockPool pool(sizeof(T), alignof(T), PoolAllocator<Tag>::GetStats());
+        return pool;
+    }
+
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = PoolAllocator<U, Tag>;
+    };
+
+    PoolAllocator() = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U, Tag>&) {}
+
+    T* allocate(size_t count) {
+        if (count != 1) return static_cast<T*>(::operator new(count * sizeof(T)));
+        return static_cast<T*>(Pool().Allocate());
+    }
+
+    void deallocate(T* pointer, size_t count) {
+        if (count != 1) ::operator delete(pointer);
+        else Pool().Deallocate(pointer);
+    }
+
+    // The pools of every type PoolAllocator<Tag> is rebound to report into its stats
+    static PoolStats& GetStats() {
+        static PoolStats stats;
+        return stats;
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U, Tag>&) const { return true; }
+};
+
+class ObjectPool {
+public:
+    // std::make_shared, but from T's pool
+    template <typename T, typename... Args>
+    static std::shared_ptr<T> MakeShared(Args&&... args) {
+        return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    static const PoolStats& GetStats() {
+        return PoolAllocator<T>::GetStats();
+    }
+};
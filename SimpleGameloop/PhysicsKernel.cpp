@@ -0,0 +1,208 @@
+#include "PhysicsKernel.h"
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PHYSICS_KERNEL_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(PHYSICS_KERNEL_X86) && defined(__GNUC__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+
+// One body of the scalar path; returns whether it touched an edge.
+// Bounds are expressed in the body's local space: lower = halfSize - offset, upper = extent - halfSize - offset
+static bool StepBody(Vector2& position, Vector2& velocity, Vector2 size, Vector2 offset, bool collidable,
+    float deltaTime, float width, float height) {
+    position.x += velocity.x * deltaTime;
+    position.y += velocity.y * deltaTime;
+
+    if (!collidable) return false;
+
+    Vector2 halfSize = { size.x * 0.5f, size.y * 0.5f };
+    Vector2 lower = { halfSize.x - offset.x, halfSize.y - offset.y };
+    Vector2 upper = { (width - halfSize.x) - offset.x, (height - halfSize.y) - offset.y };
+
+    bool belowX = position.x < lower.x, aboveX = position.x > upper.x;
+    bool belowY = position.y < lower.y, aboveY = position.y > upper.y;
+
+    if (belowX) position.x = lower.x;
+    if (aboveX) position.x = upper.x;
+    if (belowY) position.y = lower.y;
+    if (aboveY) position.y = upper.y;
+    if (belowX != aboveX) velocity.x = -velocity.x;
+    if (belowY != aboveY) velocity.y = -velocity.y;
+
+    return belowX || aboveX || belowY || aboveY;
+}
+
+static void IntegrateAndConstrainScalar(const BodyArrays& bodies, size_t begin, float deltaTime,
+    float width, float height, std::vector<size_t>& wallHits) {
+    for (size_t i = begin; i < bodies.count; ++i) {
+        if (StepBody(bodies.positions[i], bodies.velocities[i], bodies.sizes[i], bodies.parentOffsets[i], bodies.collidable[i] != 0,
+            deltaTime, width, height))
+            wallHits.push_back(i);
+    }
+}
+
+#ifdef PHYSICS_KERNEL_X86
+
+// Two bodies (x0 y0 x1 y1) per register; returns the first index left for the scalar tail
+TARGET_SSE2 static size_t IntegrateAndConstrainSse2(const BodyArrays& bodies, float deltaTime,
+    float width, float height, std::vector<size_t>& wallHits) {
+    float* positions = reinterpret_cast<float*>(bodies.positions);
+    float* velocities = reinterpret_cast<float*>(bodies.velocities);
+    const float* sizes = reinterpret_cast<const float*>(bodies.sizes);
+    const float* offsets = reinterpret_cast<const float*>(bodies.parentOffsets);
+
+    const __m128 delta = _mm_set1_ps(deltaTime);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 extent = _mm_setr_ps(width, height, width, height);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    size_t i = 0;
+    for (; i + 2 <= bodies.count; i += 2) {
+        __m128 position = _mm_loadu_ps(positions + 2 * i);
+        __m128 velocity = _mm_loadu_ps(velocities + 2 * i);
+        position = _mm_add_ps(position, _mm_mul_ps(velocity, delta));
+
+        int first = bodies.collidable[i] ? -1 : 0;
+        int second = bodies.collidable[i + 1] ? -1 : 0;
+        __m128 collidable = _mm_castsi128_ps(_mm_setr_epi32(first, first, second, second));
+
+        __m128 halfSize = _mm_mul_ps(_mm_loadu_ps(sizes + 2 * i), half);
+        __m128 offset = _mm_loadu_ps(offsets + 2 * i);
+        __m128 lower = _mm_sub_ps(halfSize, offset);
+        __m128 upper = _mm_sub_ps(_mm_sub_ps(extent, halfSize), offset);
+
+        __m128 below = _mm_and_ps(_mm_cmplt_ps(position, lower), collidable);
+        __m128 above = _mm_and_ps(_mm_cmpgt_ps(position, upper), collidable);
+
+        position = _mm_or_ps(_mm_and_ps(below, lower), _mm_andnot_ps(below, position));
+        position = _mm_or_ps(_mm_and_ps(above, upper), _mm_andnot_ps(above, position));
+        velocity = _mm_xor_ps(velocity, _mm_and_ps(_mm_xor_ps(below, above), signBit));
+
+        _mm_storeu_ps(positions + 2 * i, position);
+        _mm_storeu_ps(velocities + 2 * i, velocity);
+
+        int hitMask = _mm_movemask_ps(_mm_or_ps(below, above));
+        if (hitMask & 0x3) wallHits.push_back(i);
+        if (hitMask & 0xC) wallHits.push_back(i + 1);
+    }
+    return i;
+}
+
+// Four bodies per register
+TARGET_AVX2 static size_t IntegrateAndConstrainAvx2(const BodyArrays& bodies, float deltaTime,
+    float width, float height, std::vector<size_t>& wallHits) {
+    float* positions = reinterpret_cast<float*>(bodies.positions);
+    float* velocities = reinterpret_cast<float*>(bodies.velocities);
+    const float* sizes = reinterpret_cast<const float*>(bodies.sizes);
+    const float* offsets = reinterpret_cast<const float*>(bodies.parentOffsets);
+
+    const __m256 delta = _mm256_set1_ps(deltaTime);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 extent = _mm256_setr_ps(width, height, width, height, width, height, width, height);
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= bodies.count; i += 4) {
+        __m256 position = _mm256_loadu_ps(positions + 2 * i);
+        __m256 velocity = _mm256_loadu_ps(velocities + 2 * i);
+        position = _mm256_add_ps(position, _mm256_mul_ps(velocity, delta));
+
+        // Widen four collidable bytes to eight lanes, one per x/y component
+        int flags;
+        std::memcpy(&flags, bodies.collidable + i, sizeof(flags));
+        __m128i flagBytes = _mm_cvtsi32_si128(flags);
+        __m256i flagLanes = _mm256_cvtepu8_epi32(_mm_unpacklo_epi8(flagBytes, flagBytes));
+        __m256 collidable = _mm256_castsi256_ps(_mm256_cmpgt_epi32(flagLanes, _mm256_setzero_si256()));
+
+        __m256 halfSize = _mm256_mul_ps(_mm256_loadu_ps(sizes + 2 * i), half);
+        __m256 offset = _mm256_loadu_ps(offsets + 2 * i);
+        __m256 lower = _mm256_sub_ps(halfSize, offset);
+        __m256 upper = _mm256_sub_ps(_mm256_sub_ps(extent, halfSize), offset);
+
+        __m256 below = _mm256_and_ps(_mm256_cmp_ps(position, lower, _CMP_LT_OQ), collidable);
+        __m256 above = _mm256_and_ps(_mm256_cmp_ps(position, upper, _CMP_GT_OQ), collidable);
+
+        position = _mm256_blendv_ps(position, lower, below);
+        position = _mm256_blendv_ps(position, upper, above);
+        velocity = _mm256_xor_ps(velocity, _mm256_and_ps(_mm256_xor_ps(below, above), signBit));
+
+        _mm256_storeu_ps(positions + 2 * i, position);
+        _mm256_storeu_ps(velocities + 2 * i, velocity);
+
+        int hitMask = _mm256_movemask_ps(_mm256_or_ps(below, above));
+        if (hitMask) {
+            for (size_t body = 0; body < 4; ++body)
+                if (hitMask & (0x3 << (2 * body))) wallHits.push_back(i + body);
+        }
+    }
+    return i;
+}
+
+#endif
+
+SimdLevel PhysicsKernel::DetectSimdLevel() {
+#ifdef PHYSICS_KERNEL_X86
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    bool sse2 = __builtin_cpu_supports("sse2");
+    bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    if (avx2) return SimdLevel::AVX2;
+    if (sse2) return SimdLevel::SSE2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+const char* PhysicsKernel::GetSimdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::SSE2: return "SSE2";
+    case SimdLevel::AVX2: return "AVX2";
+    default: return "Scalar";
+    }
+}
+
+Vector2 PhysicsKernel::ProjectPosition(Vector2 position, Vector2 velocity, Vector2 size, Vector2 parentOffset, bool collidable,
+    float deltaTime, int boundsWidth, int boundsHeight) {
+    StepBody(position, velocity, size, parentOffset, collidable, deltaTime, static_cast<float>(boundsWidth), static_cast<float>(boundsHeight));
+    return position;
+}
+
+void PhysicsKernel::IntegrateAndConstrain(SimdLevel level, const BodyArrays& bodies, float deltaTime,
+    int boundsWidth, int boundsHeight, std::vector<size_t>& wallHits) {
+    float width = static_cast<float>(boundsWidth);
+    float height = static_cast<float>(boundsHeight);
+    size_t vectorized = 0;
+
+#ifdef PHYSICS_KERNEL_X86
+    if (level == SimdLevel::AVX2) vectorized = IntegrateAndConstrainAvx2(bodies, deltaTime, width, height, wallHits);
+    else if (level == SimdLevel::SSE2) vectorized = IntegrateAndConstrainSse2(bodies, deltaTime, width, height, wallHits);
+#endif
+
+    IntegrateAndConstrainScalar(bodies, vectorized, deltaTime, width, height, wallHits);
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "raylib.h"
+#include <vector>
+#include <cstdint>
+
+enum class SimdLevel {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+// Views of the EntityStore arrays the kernel reads and writes
+struct BodyArrays {
+    Vector2* positions;
+    Vector2* velocities;
+    const Vector2* sizes;
+    const Vector2* parentOffsets;
+    const uint8_t* collidable;
+    size_t count;
+};
+
+// Fused per-tick body step: position += velocity * dt, then collidable bodies are clamped to
+// [0, width] x [0, height] in global space with the crossed velocity components flipped. Every
+// path produces bit-identical results; the SIMD ones are picked at runtime from what the CPU supports.
+class PhysicsKernel {
+public:
+    static SimdLevel DetectSimdLevel();
+    static const char* GetSimdLevelName(SimdLevel level);
+
+    // Appends the index of every body that touched an edge to wallHits
+    static void IntegrateAndConstrain(SimdLevel level, const BodyArrays& bodies, float deltaTime,
+        int boundsWidth, int boundsHeight, std::vector<size_t>& wallHits);
+    // The local position one body will have after IntegrateAndConstrain, without changing anything
+    static Vector2 ProjectPosition(Vector2 position, Vector2 velocity, Vector2 size, Vector2 parentOffset, bool collidable,
+        float deltaTime, int boundsWidth, int boundsHeight);
+};
@@ -1,4 +1,5 @@
 #include "Platform.h"
+#include "ObjectPool.h"
 
 Platform::Platform(
     ResourceManager& resourceManager,
@@ -9,17 +10,42 @@ Platform::Platform(
     const std::string& texturePath,
     const std::string& bounceSoundPath,
     bool collidable
-) : Sprite(initialPosition, size, 0.0, expectedVelocity, shape, collidable),
+) : Platform(resourceManager, initialPosition, size, expectedVelocity,
+    resourceManager.GetSpriteAssets(texturePath, bounceSoundPath, size.x, size.y), shape, collidable) {}
+
+Platform::Platform(
+    ResourceManager& resourceManager,
+    Vector2 initialPosition,
+    Vector2 size,
+    Vector2 expectedVelocity,
+    SpriteAssets assets,
+    ShapeType shape,
+    bool collidable
+) : Sprite(TYPE, initialPosition, size, 0.0, expectedVelocity, shape, collidable),
+texture(assets.texture),
+bounceSound(assets.sound),
 expectedVelocity(expectedVelocity),
-texturePath(texturePath),
-bounceSoundPath(bounceSoundPath),
-resourceManager(resourceManager)
-{
-    texture = resourceManager.GetTexture(texturePath, size.x, size.y);
-    bounceSound = resourceManager.GetSound(bounceSoundPath);
+resourceManager(resourceManager) {
+    resourceManager.Retain(texture);
+    resourceManager.Retain(bounceSound);
 }
 
-void Platform::Update(float deltaTime, int screenWidth, int screenHeight) {
+Platform::~Platform() {
+    resourceManager.Release(texture);
+    resourceManager.Release(bounceSound);
+}
+
+SpriteAssets Platform::GetDefaultAssets(ResourceManager& resourceManager, Vector2 size) {
+    return resourceManager.GetSpriteAssets(DEFAULT_TEXTURE, DEFAULT_SOUND, size.x, size.y);
+}
+
+std::shared_ptr<Sprite> Platform::Create(ResourceManager& resourceManager, Vector2 position, Vector2 size, Vector2 velocity, const SpriteAssets& assets) {
+    return ObjectPool::MakeShared<Platform>(resourceManager, position, size, velocity, assets);
+}
+
+void Platform::Update(float deltaTime, int screenWidth, int screenHeight, const InputState& input) {
+    Vector2& velocity = Velocity();
+
     float dotProduct = velocity.x * expectedVelocity.x + velocity.y * expectedVelocity.y;
 
     if (dotProduct >= 0.0f) velocity = expectedVelocity;
@@ -27,30 +53,35 @@ void Platform::Update(float deltaTime, int screenWidth, int screenHeight) {
 }
 
 void Platform::OnCollision() const {
-    PlaySound(bounceSound);
+    PlaySound(resourceManager.GetSound(bounceSound));
 }
 
-void Platform::Draw(int global_x, int global_y) const {
-    Rectangle source = { 0, 0, (float)texture.width, (float)texture.height };
-    Rectangle destination = { global_x, global_y, size.x, size.y };
-    Vector2 origin = { size.x / 2.0f, size.y / 2.0f };
+void Platform::QueueDraw(RenderQueue& queue, uint32_t order, Vector2 position, float rotation) const {
+    Rectangle destination = { position.x, position.y, Size().x, Size().y };
+    Vector2 origin = { Size().x / 2.0f, Size().y / 2.0f };
+    const AtlasRegion& region = resourceManager.GetTexture(texture);
 
-    DrawTexturePro(texture, source, destination, origin, rotation, WHITE);
+    queue.Add({ TerrainLayer, order, region.texture, region.source, destination, origin, rotation });
 }
 
-void Platform::Save(std::ofstream& file) const {
-    Sprite::Save(file);
-    file.write((char*)&expectedVelocity, sizeof(expectedVelocity));
-    resourceManager.SaveResourceKey(file, texturePath);
-    resourceManager.SaveResourceKey(file, bounceSoundPath);
+void Platform::Save(EntityRecord& record, SnapshotStringTable& strings) const {
+    Sprite::Save(record, strings);
+    record.params[0] = expectedVelocity.x;
+    record.params[1] = expectedVelocity.y;
+    record.texture = strings.Intern(resourceManager.GetTexturePath(texture));
+    record.sound = strings.Intern(resourceManager.GetSoundPath(bounceSound));
 }
 
-void Platform::Load(std::ifstream& file) {
-    Sprite::Load(file);
-    file.read((char*)&expectedVelocity, sizeof(expectedVelocity));
-    texturePath = resourceManager.LoadResourceKey(file);
-    bounceSoundPath = resourceManager.LoadResourceKey(file);
-
-    texture = resourceManager.GetTexture(texturePath, size.x, size.y);
-    bounceSound = resourceManager.GetSound(bounceSoundPath);
+void Platform::Load(const EntityRecord& record, const SnapshotStringTable& strings) {
+    Sprite::Load(record, strings);
+    expectedVelocity = { record.params[0], record.params[1] };
+    TextureHandle loadedTexture = resourceManager.RequestTexture(strings, record.texture, Size().x, Size().y);
+    SoundHandle loadedSound = resourceManager.RequestSound(strings, record.sound);
+    // Retained before the old handles are released, so assets shared by both are never evicted
+    resourceManager.Retain(loadedTexture);
+    resourceManager.Retain(loadedSound);
+    resourceManager.Release(texture);
+    resourceManager.Release(bounceSound);
+    texture = loadedTexture;
+    bounceSound = loadedSound;
 }
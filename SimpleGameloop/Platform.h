@@ -4,31 +4,51 @@
 #include "Sprite.h"
 #include "ResourceManager.h"
 #include <cmath>
+#include <memory>
 
 class Platform : public Sprite {
 private:
-    std::string texturePath;
-    std::string bounceSoundPath;
-    Texture2D texture;
-    Sound bounceSound;
+    TextureHandle texture;
+    SoundHandle bounceSound;
     Vector2 expectedVelocity;
     ResourceManager& resourceManager;
 
 public:
+    static constexpr SpriteType TYPE = SpriteType::PlatformSprite;
+    static constexpr const char* TYPE_NAME = "Platform";
+    static constexpr const char* DEFAULT_TEXTURE = "resources/background.png";
+    static constexpr const char* DEFAULT_SOUND = "resources/bounce.mp3";
+
     Platform(
         ResourceManager& resourceManager,
         Vector2 initialPosition,
         Vector2 size,
         Vector2 expectedVelocity,
         ShapeType shape = Rectangular,
-        const std::string& texturePath = "resources/background.png",
-        const std::string& bounceSoundPath = "resources/bounce.mp3",
+        const std::string& texturePath = DEFAULT_TEXTURE,
+        const std::string& bounceSoundPath = DEFAULT_SOUND,
         bool collidable = true
     );
+    // With assets already looked up, e.g. once for a whole batch by SpriteFactory
+    Platform(
+        ResourceManager& resourceManager,
+        Vector2 initialPosition,
+        Vector2 size,
+        Vector2 expectedVelocity,
+        SpriteAssets assets,
+        ShapeType shape = Rectangular,
+        bool collidable = true
+    );
+
+    ~Platform() override;
+
+    // SpriteRegistry hooks
+    static SpriteAssets GetDefaultAssets(ResourceManager& resourceManager, Vector2 size);
+    static std::shared_ptr<Sprite> Create(ResourceManager& resourceManager, Vector2 position, Vector2 size, Vector2 velocity, const SpriteAssets& assets);
 
-    void Update(float deltaTime, int screenWidth, int screenHeight) override;
+    void Update(float deltaTime, int screenWidth, int screenHeight, const InputState& input) override;
     void OnCollision() const override;
-    void Draw(int global_x, int global_y) const override;
-    void Save(std::ofstream& file) const override;
-    void Load(std::ifstream& file) override;
+    void QueueDraw(RenderQueue& queue, uint32_t order, Vector2 position, float rotation) const override;
+    void Save(EntityRecord& record, SnapshotStringTable& strings) const override;
+    void Load(const EntityRecord& record, const SnapshotStringTable& strings) override;
 };
@@ -1,4 +1,5 @@
 #include "Player.h"
+#include "ObjectPool.h"
 
 Player::Player(
     ResourceManager& resourceManager,
@@ -8,48 +9,77 @@ Player::Player(
     const std::string& texturePath,
     const std::string& bounceSoundPath,
     bool collidable
-) : Sprite(initialPosition, size, 0.0, { 0, 0 }, shape, collidable),
-texturePath(texturePath),
-bounceSoundPath(bounceSoundPath),
-resourceManager(resourceManager)
-{
-    texture = resourceManager.GetTexture(texturePath, size.x, size.y);
-    bounceSound = resourceManager.GetSound(bounceSoundPath);
+) : Player(resourceManager, initialPosition, size, resourceManager.GetSpriteAssets(texturePath, bounceSoundPath, size.x, size.y), shape, collidable) {}
+
+Player::Player(
+    ResourceManager& resourceManager,
+    Vector2 initialPosition,
+    Vector2 size,
+    SpriteAssets assets,
+    ShapeType shape,
+    bool collidable
+) : Sprite(TYPE, initialPosition, size, 0.0, { 0, 0 }, shape, collidable),
+texture(assets.texture),
+bounceSound(assets.sound),
+resourceManager(resourceManager) {
+    resourceManager.Retain(texture);
+    resourceManager.Retain(bounceSound);
 }
 
-void Player::Update(float deltaTime, int screenWidth, int screenHeight) {
-    if (IsKeyDown(KEY_W)) velocity.y -= ACCELERATION * deltaTime;
-    if (IsKeyDown(KEY_S)) velocity.y += ACCELERATION * deltaTime;
-    if (IsKeyDown(KEY_A)) velocity.x -= ACCELERATION * deltaTime;
-    if (IsKeyDown(KEY_D)) velocity.x += ACCELERATION * deltaTime;
+Player::~Player() {
+    resourceManager.Release(texture);
+    resourceManager.Release(bounceSound);
+}
 
-    Vector2 mousePosition = GetMousePosition();
-    rotation = atan2f(mousePosition.y - position.y, mousePosition.x - position.x) * RAD2DEG + ROTATION_OFFSET;
+SpriteAssets Player::GetDefaultAssets(ResourceManager& resourceManager, Vector2 size) {
+    return resourceManager.GetSpriteAssets(DEFAULT_TEXTURE, DEFAULT_SOUND, size.x, size.y);
 }
 
-void Player::OnCollision() const {
-    PlaySound(bounceSound);
+std::shared_ptr<Sprite> Player::Create(ResourceManager& resourceManager, Vector2 position, Vector2 size, Vector2 velocity, const SpriteAssets& assets) {
+    auto player = ObjectPool::MakeShared<Player>(resourceManager, position, size, assets);
+    player->Velocity() = velocity;
+    return player;
 }
 
-void Player::Draw(int global_x, int global_y) const {
-    Rectangle source = { 0, 0, (float)texture.width, (float)texture.height };
-    Rectangle destination = { global_x, global_y, size.x, size.y };
-    Vector2 origin = { size.x / 2.0f, size.y / 2.0f };
+void Player::Update(float deltaTime, int screenWidth, int screenHeight, const InputState& input) {
+    Vector2& velocity = Velocity();
+
+    if (input.IsDown(InputState::MoveUp)) velocity.y -= ACCELERATION * deltaTime;
+    if (input.IsDown(InputState::MoveDown)) velocity.y += ACCELERATION * deltaTime;
+    if (input.IsDown(InputState::MoveLeft)) velocity.x -= ACCELERATION * deltaTime;
+    if (input.IsDown(InputState::MoveRight)) velocity.x += ACCELERATION * deltaTime;
 
-    DrawTexturePro(texture, source, destination, origin, rotation, WHITE);
+    Vector2 mousePosition = input.mousePosition;
+    Rotation() = atan2f(mousePosition.y - Position().y, mousePosition.x - Position().x) * RAD2DEG + ROTATION_OFFSET;
 }
 
-void Player::Save(std::ofstream& file) const {
-    Sprite::Save(file);
-    resourceManager.SaveResourceKey(file, texturePath);
-    resourceManager.SaveResourceKey(file, bounceSoundPath);
+void Player::OnCollision() const {
+    PlaySound(resourceManager.GetSound(bounceSound));
 }
 
-void Player::Load(std::ifstream& file) {
-    Sprite::Load(file);
-    texturePath = resourceManager.LoadResourceKey(file);
-    bounceSoundPath = resourceManager.LoadResourceKey(file);
+void Player::QueueDraw(RenderQueue& queue, uint32_t order, Vector2 position, float rotation) const {
+    Rectangle destination = { position.x, position.y, Size().x, Size().y };
+    Vector2 origin = { Size().x / 2.0f, Size().y / 2.0f };
+    const AtlasRegion& region = resourceManager.GetTexture(texture);
+
+    queue.Add({ ActorLayer, order, region.texture, region.source, destination, origin, rotation });
+}
+
+void Player::Save(EntityRecord& record, SnapshotStringTable& strings) const {
+    Sprite::Save(record, strings);
+    record.texture = strings.Intern(resourceManager.GetTexturePath(texture));
+    record.sound = strings.Intern(resourceManager.GetSoundPath(bounceSound));
+}
 
-    texture = resourceManager.GetTexture(texturePath, size.x, size.y);
-    bounceSound = resourceManager.GetSound(bounceSoundPath);
+void Player::Load(const EntityRecord& record, const SnapshotStringTable& strings) {
+    Sprite::Load(record, strings);
+    TextureHandle loadedTexture = resourceManager.RequestTexture(strings, record.texture, Size().x, Size().y);
+    SoundHandle loadedSound = resourceManager.RequestSound(strings, record.sound);
+    // Retained before the old handles are released, so assets shared by both are never evicted
+    resourceManager.Retain(loadedTexture);
+    resourceManager.Retain(loadedSound);
+    resourceManager.Release(texture);
+    resourceManager.Release(bounceSound);
+    texture = loadedTexture;
+    bounceSound = loadedSound;
 }
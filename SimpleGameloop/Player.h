@@ -4,32 +4,51 @@
 #include "Sprite.h"
 #include "ResourceManager.h"
 #include <cmath>
+#include <memory>
 
 constexpr float ACCELERATION = 1000.0f;
 constexpr float ROTATION_OFFSET = 20.0f;
 
 class Player : public Sprite {
 private:
-    std::string texturePath;
-    std::string bounceSoundPath;
-    Texture2D texture;
-    Sound bounceSound;
+    TextureHandle texture;
+    SoundHandle bounceSound;
     ResourceManager& resourceManager;
 
 public:
+    static constexpr SpriteType TYPE = SpriteType::PlayerSprite;
+    static constexpr const char* TYPE_NAME = "Player";
+    static constexpr const char* DEFAULT_TEXTURE = "resources/player.png";
+    static constexpr const char* DEFAULT_SOUND = "resources/bounce.mp3";
+
+    Player(
+        ResourceManager& resourceManager,
+        Vector2 initialPosition,
+        Vector2 size,
+        ShapeType shape = Circular,
+        const std::string& texturePath = DEFAULT_TEXTURE,
+        const std::string& bounceSoundPath = DEFAULT_SOUND,
+        bool collidable = true
+    );
+    // With assets already looked up, e.g. once for a whole batch by SpriteFactory
     Player(
         ResourceManager& resourceManager,
         Vector2 initialPosition,
         Vector2 size,
+        SpriteAssets assets,
         ShapeType shape = Circular,
-        const std::string& texturePath = "resources/player.png",
-        const std::string& bounceSoundPath = "resources/bounce.mp3",
         bool collidable = true
     );
 
-    void Update(float deltaTime, int screenWidth, int screenHeight) override;
+    ~Player() override;
+
+    // SpriteRegistry hooks
+    static SpriteAssets GetDefaultAssets(ResourceManager& resourceManager, Vector2 size);
+    static std::shared_ptr<Sprite> Create(ResourceManager& resourceManager, Vector2 position, Vector2 size, Vector2 velocity, const SpriteAssets& assets);
+
+    void Update(float deltaTime, int screenWidth, int screenHeight, const InputState& input) override;
     void OnCollision() const override;
-    void Draw(int global_x, int global_y) const override;
-    void Save(std::ofstream& file) const override;
-    void Load(std::ifstream& file) override;
+    void QueueDraw(RenderQueue& queue, uint32_t order, Vector2 position, float rotation) const override;
+    void Save(EntityRecord& record, SnapshotStringTable& strings) const override;
+    void Load(const EntityRecord& record, const SnapshotStringTable& strings) override;
 };
@@ -1,17 +1,28 @@
 #pragma once
-#include "SceneNode.h"
+#include "BroadPhase.h"
 #include <vector>
 #include <memory>
 #include <algorithm>
 
-class Quadtree {
+// Persistent quadtree: entities are moved between cells as their bounds change instead of
+// rebuilding the tree every frame. Each SceneNode remembers the cell that holds it. Children
+// of a merged cell stay allocated and are reused by the next split, so steady-state updates
+// do not touch the heap.
+class Quadtree : public BroadPhase {
 private:
     static const int MAX_OBJECTS = 5;
     static const int MAX_LEVELS = 5;
 
     Rectangle bounds;
+    int level;
+    Quadtree* parent;
+    bool split = false;
+    size_t subtreeCount = 0; // Objects held by this cell and all active descendants
     std::vector<std::shared_ptr<SceneNode>> objects;
     std::unique_ptr<Quadtree> children[4];
+    std::vector<SceneNode*> ancestorScratch; // Reused by CollectPairs on the root
+
+    Quadtree(Rectangle bounds, int level, Quadtree* parent) : bounds(bounds), level(level), parent(parent) {}
 
     int GetIndex(const Rectangle& rect) const {
         float verticalMidpoint = bounds.x + bounds.width / 2.0f;
@@ -31,66 +42,191 @@ private:
     }
 
     void Split() {
-        float subWidth = bounds.width / 2.0f;
-        float subHeight = bounds.height / 2.0f;
+        if (!children[0]) {
+            float subWidth = bounds.width / 2.0f;
+            float subHeight = bounds.height / 2.0f;
+
+            children[0].reset(new Quadtree(Rectangle{ bounds.x, bounds.y, subWidth, subHeight }, level + 1, this));
+            children[1].reset(new Quadtree(Rectangle{ bounds.x + subWidth, bounds.y, subWidth, subHeight }, level + 1, this));
+            children[2].reset(new Quadtree(Rectangle{ bounds.x, bounds.y + subHeight, subWidth, subHeight }, level + 1, this));
+            children[3].reset(new Quadtree(Rectangle{ bounds.x + subWidth, bounds.y + subHeight, subWidth, subHeight }, level + 1, this));
+        }
+        split = true;
 
-        children[0] = std::make_unique<Quadtree>(Rectangle{ bounds.x, bounds.y, subWidth, subHeight });
-        children[1] = std::make_unique<Quadtree>(Rectangle{ bounds.x + subWidth, bounds.y, subWidth, subHeight });
-        children[2] = std::make_unique<Quadtree>(Rectangle{ bounds.x, bounds.y + subHeight, subWidth, subHeight });
-        children[3] = std::make_unique<Quadtree>(Rectangle{ bounds.x + subWidth, bounds.y + subHeight, subWidth, subHeight });
+        size_t i = 0;
+        while (i < objects.size()) {
+            Rectangle rect = objects[i]->GetBounds();
+            int index = GetIndex(rect);
+            if (index != -1) {
+                children[index]->InsertAt(std::move(objects[i]), rect);
+                objects[i] = std::move(objects.back());
+                objects.pop_back();
+            }
+            else ++i;
+        }
     }
 
-public:
-    Quadtree(Rectangle bounds) : bounds(bounds) {}
+    // Pulls every object of the subtree back into this cell and deactivates the children
+    void Merge() {
+        for (auto& child : children) child->MoveObjectsTo(*this);
+        split = false;
+    }
 
-    void Clear() {
+    void MoveObjectsTo(Quadtree& target) {
+        if (split)
+            for (auto& child : children) child->MoveObjectsTo(target);
+
+        for (auto& object : objects) {
+            object->quadtreeCell = &target;
+            target.objects.push_back(std::move(object));
+        }
         objects.clear();
-        for (auto& child : children) child.reset();
+        split = false;
+        subtreeCount = 0;
     }
 
-    void Insert(std::shared_ptr<SceneNode> node) {
-        if (children[0]) {
-            int index = GetIndex(node->GetBounds());
+    void InsertAt(std::shared_ptr<SceneNode> node, const Rectangle& rect) {
+        ++subtreeCount;
+
+        if (split) {
+            int index = GetIndex(rect);
             if (index != -1) {
-                children[index]->Insert(node);
+                children[index]->InsertAt(std::move(node), rect);
                 return;
             }
         }
 
-        objects.push_back(node);
+        node->quadtreeCell = this;
+        objects.push_back(std::move(node));
 
-        if (objects.size() > MAX_OBJECTS && !children[0]) {
-            Split();
+        if (!split && objects.size() > MAX_OBJECTS && level < MAX_LEVELS) Split();
+    }
 
-            auto it = objects.begin();
-            while (it != objects.end()) {
-                int index = GetIndex((*it)->GetBounds());
-                if (index != -1) {
-                    children[index]->Insert(*it);
-                    it = objects.erase(it);
-                }
-                else ++it;
-            }
+    // Cell the rectangle would be stored in if it were inserted now
+    const Quadtree* Locate(const Rectangle& rect) const {
+        const Quadtree* cell = this;
+        while (cell->split) {
+            int index = cell->GetIndex(rect);
+            if (index == -1) break;
+            cell = cell->children[index].get();
         }
+        return cell;
     }
 
-    std::vector<std::shared_ptr<SceneNode>> Retrieve(const Rectangle& rect) const {
-        std::vector<std::shared_ptr<SceneNode>> result;
+    std::shared_ptr<SceneNode> Detach(SceneNode& node) {
+        Quadtree* cell = node.quadtreeCell;
+        auto found = std::find_if(cell->objects.begin(), cell->objects.end(),
+            [&node](const std::shared_ptr<SceneNode>& object) { return object.get() == &node; });
+
+        std::shared_ptr<SceneNode> detached = std::move(*found);
+        *found = std::move(cell->objects.back());
+        cell->objects.pop_back();
+        node.quadtreeCell = nullptr;
+
+        for (Quadtree* ancestor = cell; ancestor; ancestor = ancestor->parent) --ancestor->subtreeCount;
+        return detached;
+    }
+
+    void CollectPairs(std::vector<std::pair<SceneNode*, SceneNode*>>& pairs, std::vector<SceneNode*>& ancestors) const {
+        size_t ancestorCount = ancestors.size();
+
+        for (const auto& object : objects) {
+            if (!object->IsCollidable()) continue;
+
+            for (size_t i = 0; i < ancestors.size(); ++i) pairs.emplace_back(ancestors[i], object.get());
+            ancestors.push_back(object.get());
+        }
+
+        if (split)
+            for (const auto& child : children) child->CollectPairs(pairs, ancestors);
 
-        int index = GetIndex(rect);
+        ancestors.resize(ancestorCount);
+    }
 
-        if (children[0]) {
+    template <typename Visitor>
+    void ForEachObject(const Rectangle& rect, Visitor&& visitor) const {
+        if (split) {
+            int index = GetIndex(rect);
             if (index == -1)
-                for (const auto& child : children) {
-                    auto childResult = child->Retrieve(rect);
-                    result.insert(result.end(), childResult.begin(), childResult.end());
-                }
-            else {
-                auto childResult = children[index]->Retrieve(rect);
-                result.insert(result.end(), childResult.begin(), childResult.end());
-            }
+                for (const auto& child : children) child->ForEachObject(rect, visitor);
+            else
+                children[index]->ForEachObject(rect, visitor);
+        }
+        for (const auto& object : objects) visitor(object);
+    }
+
+    void MergeEmptiedAncestors(Quadtree* cell) {
+        for (; cell; cell = cell->parent)
+            if (cell->split && cell->subtreeCount <= MAX_OBJECTS) cell->Merge();
+    }
+
+public:
+    Quadtree(Rectangle bounds) : Quadtree(bounds, 0, nullptr) {}
+
+    Quadtree(const Quadtree&) = delete;
+    Quadtree& operator=(const Quadtree&) = delete;
+
+    ~Quadtree() override {
+        for (auto& object : objects)
+            if (object->quadtreeCell == this) object->quadtreeCell = nullptr;
+    }
+
+    void Clear() override {
+        for (auto& object : objects) object->quadtreeCell = nullptr;
+        objects.clear();
+        if (split)
+            for (auto& child : children) child->Clear();
+        split = false;
+        subtreeCount = 0;
+    }
+
+    void Insert(std::shared_ptr<SceneNode> node) {
+        Rectangle rect = node->GetBounds();
+        InsertAt(std::move(node), rect);
+    }
+
+    void Update(const std::shared_ptr<SceneNode>& node) override {
+        if (!node->quadtreeCell) {
+            Insert(node);
+            return;
         }
-        result.insert(result.end(), objects.begin(), objects.end());
+
+        Rectangle rect = node->GetBounds();
+        Quadtree* previousCell = node->quadtreeCell;
+        if (Locate(rect) == previousCell) return;
+
+        InsertAt(Detach(*node), rect);
+        MergeEmptiedAncestors(previousCell);
+    }
+
+    void Remove(SceneNode& node) override {
+        if (!node.quadtreeCell) return;
+
+        Quadtree* previousCell = node.quadtreeCell;
+        Detach(node);
+        MergeEmptiedAncestors(previousCell);
+    }
+
+    // Pairs objects that share a cell or sit in a cell and one of its ancestors
+    void CollectPairs(std::vector<std::pair<SceneNode*, SceneNode*>>& pairs) override {
+        ancestorScratch.clear();
+        CollectPairs(pairs, ancestorScratch);
+    }
+
+    // Calls visitor(SceneNode*) for every object Retrieve would return, without building a container
+    template <typename Visitor>
+    void Query(const Rectangle& rect, Visitor&& visitor) const {
+        ForEachObject(rect, [&visitor](const std::shared_ptr<SceneNode>& object) { visitor(object.get()); });
+    }
+
+    // Appends to a caller-owned buffer so a reused scratch vector makes queries allocation-free
+    void Retrieve(const Rectangle& rect, std::vector<SceneNode*>& result) const override {
+        Query(rect, [&result](SceneNode* node) { result.push_back(node); });
+    }
+
+    std::vector<std::shared_ptr<SceneNode>> Retrieve(const Rectangle& rect) const {
+        std::vector<std::shared_ptr<SceneNode>> result;
+        ForEachObject(rect, [&result](const std::shared_ptr<SceneNode>& object) { result.push_back(object); });
         return result;
     }
 
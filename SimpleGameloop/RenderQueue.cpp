@@ -0,0 +1,40 @@
+#include "RenderQueue.h"
+#include <algorithm>
+#include <cmath>
+
+void RenderQueue::Begin(const Rectangle& viewport) {
+    this->viewport = viewport;
+    commands.clear();
+}
+
+void RenderQueue::Add(const DrawCommand& command) {
+    // The quad rotates about origin; no corner can get further from it than this
+    const Rectangle& destination = command.destination;
+    const Vector2& origin = command.origin;
+    float reach = std::max(std::fabs(origin.x), std::fabs(destination.width - origin.x)) +
+        std::max(std::fabs(origin.y), std::fabs(destination.height - origin.y));
+    if (destination.x + reach < viewport.x || destination.x - reach > viewport.x + viewport.width ||
+        destination.y + reach < viewport.y || destination.y - reach > viewport.y + viewport.height) return;
+
+    commands.push_back(command);
+}
+
+size_t RenderQueue::Sort() {
+    std::sort(commands.begin(), commands.end(), [](const DrawCommand& a, const DrawCommand& b) {
+        if (a.layer != b.layer) return a.layer < b.layer;
+        if (a.texture.id != b.texture.id) return a.texture.id < b.texture.id;
+        return a.order < b.order;
+    });
+
+    // A layer change alone does not flush raylib's batch, only binding another texture does
+    if (commands.empty()) return 0;
+    size_t batches = 1;
+    for (size_t i = 1; i < commands.size(); ++i)
+        if (commands[i].texture.id != commands[i - 1].texture.id) batches++;
+    return batches;
+}
+
+void RenderQueue::Submit() const {
+    for (const DrawCommand& command : commands)
+        DrawTexturePro(command.texture, command.source, command.destination, command.origin, command.rotation, WHITE);
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "raylib.h"
+#include <vector>
+#include <cstdint>
+
+// Drawn back to front; within a layer, commands are grouped by texture
+enum DrawLayer : uint32_t {
+    BackgroundLayer = 0,
+    TerrainLayer = 1,
+    ActorLayer = 2
+};
+
+// One textured quad, as DrawTexturePro takes it
+struct DrawCommand {
+    uint32_t layer;
+    uint32_t order; // Breaks ties inside a layer and texture, so overlapping sprites keep their stacking
+    Texture2D texture;
+    Rectangle source;
+    Rectangle destination;
+    Vector2 origin;
+    float rotation;
+};
+
+struct RenderStats {
+    size_t visibleNodes = 0;    // Nodes with at least one quad on screen
+    size_t quads = 0;           // Quads submitted
+    size_t batches = 0;         // Runs of quads sharing a texture; raylib issues one draw call per run
+};
+
+// One frame's draw commands. Quads that cannot touch the viewport are dropped as they are added,
+// the rest are sorted so each texture is bound once per layer and raylib can batch them.
+class RenderQueue {
+private:
+    Rectangle viewport = { 0, 0, 0, 0 };
+    std::vector<DrawCommand> commands;
+
+public:
+    void Begin(const Rectangle& viewport);
+    const Rectangle& GetViewport() const { return viewport; }
+
+    void Add(const DrawCommand& command);
+    // Returns the number of batches Submit will produce
+    size_t Sort();
+    void Submit() const;
+
+    size_t Size() const { return commands.size(); }
+};
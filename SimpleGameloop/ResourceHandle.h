@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+
+// Names one texture in a ResourceManager. It resolves to a placeholder until the texture has
+// finished loading, and to the texture after that. The default handle is invalid.
+struct TextureHandle {
+    static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+
+    uint32_t index = INVALID_INDEX;
+
+    bool IsValid() const { return index != INVALID_INDEX; }
+    bool operator==(const TextureHandle& other) const = default;
+};
+
+// Like TextureHandle, for sounds. An invalid handle resolves to the silent default sound.
+struct SoundHandle {
+    static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+
+    uint32_t index = INVALID_INDEX;
+
+    bool IsValid() const { return index != INVALID_INDEX; }
+    bool operator==(const SoundHandle& other) const = default;
+};
@@ -1,55 +1,286 @@
 #include "ResourceManager.h"
+#include <chrono>
 
-ResourceManager::ResourceManager() : defaultSound(LoadSoundFromWave({ 0 })) {}
-
-Texture2D ResourceManager::GetTexture(const std::string& path, int width, int height) {
-    if (textures.find(path) == textures.end()) {
-        Texture2D texture = LoadTexture(path.c_str());
-        if (texture.id == 0) {
-            Image img = GenImageColor(width, height, Color{
-                static_cast<unsigned char>(rand() % 256),
-                static_cast<unsigned char>(rand() % 256),
-                static_cast<unsigned char>(rand() % 256),
-                255
-                });
-            texture = LoadTextureFromImage(img);
-            UnloadImage(img);
+const Color PLACEHOLDER_COLOR = Color{ 200, 200, 200, 255 };
+
+ResourceManager::ResourceManager(bool headless, size_t memoryBudget)
+    : atlas(!headless), headless(headless), memoryBudget(memoryBudget) {
+    if (!headless) loader = std::make_unique<AssetLoader>();
+}
+
+// Packed on first use rather than in the constructor, which may run before the window exists
+const AtlasRegion& ResourceManager::GetPlaceholderTexture() {
+    if (placeholderTexture.source.width == 0) {
+        Image img = GenImageColor(PLACEHOLDER_SIZE, PLACEHOLDER_SIZE, PLACEHOLDER_COLOR);
+        placeholderTexture = atlas.Add(img);
+        UnloadImage(img);
+    }
+    return placeholderTexture;
+}
+
+TextureHandle ResourceManager::RequestTexture(std::string_view path, int width, int height) {
+    auto found = textureHandles.find(path);
+    if (found != textureHandles.end()) return Acquire(found->second, width, height);
+
+    TextureHandle handle = { static_cast<uint32_t>(textures.size()) };
+    textureHandles.emplace(path, handle);
+    texturePaths.emplace_back(path);
+    textures.emplace_back();
+    return Acquire(handle, width, height);
+}
+
+// A hit if the asset is resident or on its way; otherwise, e.g. after an eviction, it loads again
+TextureHandle ResourceManager::Acquire(TextureHandle handle, int width, int height) {
+    if (textures[handle.index].state != AssetState::Unloaded) {
+        stats.hits++;
+        return handle;
+    }
+    stats.misses++;
+    StartLoading(handle, width, height);
+    return handle;
+}
+
+void ResourceManager::StartLoading(TextureHandle handle, int width, int height) {
+    TextureEntry& entry = textures[handle.index];
+    if (headless) {
+        // No GPU context: keep only the dimensions sprites rely on for sizing
+        entry.region = atlas.Allocate(width, height);
+        BecomeResident(entry, { false, handle.index });
+        return;
+    }
+
+    entry.region = GetPlaceholderTexture();
+    entry.state = AssetState::Loading;
+    Color fallbackColor = Color{
+        static_cast<unsigned char>(rand() % 256),
+        static_cast<unsigned char>(rand() % 256),
+        static_cast<unsigned char>(rand() % 256),
+        255
+    };
+    loader->Submit({ AssetLoader::AssetKind::Texture, handle.index, texturePaths[handle.index], width, height, fallbackColor });
+}
+
+SoundHandle ResourceManager::RequestSound(std::string_view path) {
+    if (path.empty()) return {};
+
+    auto found = soundHandles.find(path);
+    if (found != soundHandles.end()) return Acquire(found->second);
+
+    SoundHandle handle = { static_cast<uint32_t>(sounds.size()) };
+    soundHandles.emplace(path, handle);
+    soundPaths.emplace_back(path);
+    sounds.emplace_back();
+    return Acquire(handle);
+}
+
+SoundHandle ResourceManager::Acquire(SoundHandle handle) {
+    if (sounds[handle.index].state != AssetState::Unloaded) {
+        stats.hits++;
+        return handle;
+    }
+    stats.misses++;
+    StartLoading(handle);
+    return handle;
+}
+
+void ResourceManager::StartLoading(SoundHandle handle) {
+    SoundEntry& entry = sounds[handle.index];
+    if (headless) {
+        BecomeResident(entry, { true, handle.index });
+        return;
+    }
+
+    entry.state = AssetState::Loading;
+    loader->Submit({ AssetLoader::AssetKind::Sound, handle.index, soundPaths[handle.index] });
+}
+
+SpriteAssets ResourceManager::GetSpriteAssets(std::string_view texturePath, std::string_view soundPath, int width, int height) {
+    return { RequestTexture(texturePath, width, height), RequestSound(soundPath) };
+}
+
+TextureHandle ResourceManager::RequestTexture(const SnapshotStringTable& strings, uint32_t index, int width, int height) {
+    const std::string& path = strings.Get(index);
+    if (index >= texturesBySnapshotString.size()) texturesBySnapshotString.resize(strings.Size());
+
+    TextureHandle& cached = texturesBySnapshotString[index];
+    if (cached.IsValid() && texturePaths[cached.index] == path) return Acquire(cached, width, height);
+    cached = RequestTexture(path, width, height);
+    return cached;
+}
+
+SoundHandle ResourceManager::RequestSound(const SnapshotStringTable& strings, uint32_t index) {
+    const std::string& path = strings.Get(index);
+    if (index >= soundsBySnapshotString.size()) soundsBySnapshotString.resize(strings.Size());
+
+    SoundHandle& cached = soundsBySnapshotString[index];
+    if (cached.IsValid() && soundPaths[cached.index] == path) return Acquire(cached);
+    cached = RequestSound(path);
+    return cached;
+}
+
+const std::string& ResourceManager::GetSoundPath(SoundHandle handle) const {
+    static const std::string noPath;
+    return handle.IsValid() ? soundPaths[handle.index] : noPath;
+}
+
+void ResourceManager::Finalize(AssetLoader::Decoded& decoded) {
+    if (decoded.kind == AssetLoader::AssetKind::Texture) {
+        TextureEntry& entry = textures[decoded.index];
+        if (entry.state == AssetState::Loading) {
+            entry.region = atlas.Add(decoded.image);
+            BecomeResident(entry, { false, decoded.index });
         }
-        textures[path] = texture;
+        UnloadImage(decoded.image);
+        return;
     }
-    return textures[path];
+
+    SoundEntry& entry = sounds[decoded.index];
+    if (entry.state == AssetState::Loading && decoded.wave.data) {
+        entry.sound = LoadSoundFromWave(decoded.wave);
+        entry.ownsSound = true;
+        entry.bytes = static_cast<size_t>(decoded.wave.frameCount) * decoded.wave.channels * decoded.wave.sampleSize / 8;
+        residentSoundBytes += entry.bytes;
+    }
+    if (entry.state == AssetState::Loading) BecomeResident(entry, { true, decoded.index });
+    if (decoded.wave.data) UnloadWave(decoded.wave);
 }
 
-Sound ResourceManager::GetSound(const std::string& path) {
-    if (sounds.find(path) == sounds.end()) {
-        if (std::filesystem::exists(path)) sounds[path] = LoadSound(path.c_str());
-        else sounds[path] = defaultSound;
+ResourceManager::AssetEntry& ResourceManager::GetEntry(AssetKey key) {
+    if (key.isSound) return sounds[key.index];
+    return textures[key.index];
+}
+
+// Assets nobody retained by the time they finish loading are cached right away
+void ResourceManager::BecomeResident(AssetEntry& entry, AssetKey key) {
+    entry.state = AssetState::Resident;
+    if (entry.references == 0 && !entry.evictable) {
+        entry.evictionPosition = evictionOrder.insert(evictionOrder.end(), key);
+        entry.evictable = true;
     }
-    return sounds[path];
 }
 
-void ResourceManager::SaveResourceKey(std::ofstream& file, const std::string& path) {
-    size_t length = path.length();
-    file.write(reinterpret_cast<const char*>(&length), sizeof(length));
-    file.write(path.c_str(), length);
+void ResourceManager::Retain(AssetEntry& entry) {
+    if (entry.references++ > 0 || !entry.evictable) return;
+    evictionOrder.erase(entry.evictionPosition);
+    entry.evictable = false;
+}
+
+void ResourceManager::Release(AssetEntry& entry, AssetKey key) {
+    if (entry.references == 0 || --entry.references > 0) return;
+    if (entry.state == AssetState::Resident) BecomeResident(entry, key);
+}
+
+void ResourceManager::Retain(TextureHandle handle) {
+    if (handle.IsValid()) Retain(textures[handle.index]);
+}
+
+void ResourceManager::Release(TextureHandle handle) {
+    if (handle.IsValid()) Release(textures[handle.index], { false, handle.index });
+}
+
+void ResourceManager::Retain(SoundHandle handle) {
+    if (handle.IsValid()) Retain(sounds[handle.index]);
+}
+
+void ResourceManager::Release(SoundHandle handle) {
+    if (handle.IsValid()) Release(sounds[handle.index], { true, handle.index });
+}
+
+void ResourceManager::Evict(AssetKey key) {
+    AssetEntry& entry = GetEntry(key);
+    evictionOrder.erase(entry.evictionPosition);
+    entry.evictable = false;
+    entry.state = AssetState::Unloaded;
+
+    if (key.isSound) {
+        SoundEntry& sound = sounds[key.index];
+        if (sound.ownsSound) UnloadSound(sound.sound);
+        sound.sound = {};
+        sound.ownsSound = false;
+        residentSoundBytes -= sound.bytes;
+        sound.bytes = 0;
+    }
+    else {
+        TextureEntry& texture = textures[key.index];
+        atlas.Free(texture.region);
+        texture.region = headless ? AtlasRegion{} : placeholderTexture;
+    }
+    stats.evictions++;
 }
 
-std::string ResourceManager::LoadResourceKey(std::ifstream& file) {
-    size_t length;
-    file.read(reinterpret_cast<char*>(&length), sizeof(length));
-    char* buffer = new char[length + 1];
-    file.read(buffer, length);
-    buffer[length] = '\0';
-    std::string path(buffer);
-    delete[] buffer;
-    return path;
+// A page is only given back once every region on it is evicted, so this may run out of candidates
+// while still over the budget
+void ResourceManager::EvictToBudget() {
+    while (!evictionOrder.empty() && atlas.GetResidentBytes() + residentSoundBytes > memoryBudget)
+        Evict(evictionOrder.front());
 }
 
+size_t ResourceManager::Update(double budgetMilliseconds) {
+    size_t finalized = 0;
+    if (loader) {
+        auto start = std::chrono::steady_clock::now();
+        AssetLoader::Decoded decoded;
+        while (loader->PollDecoded(decoded)) {
+            Finalize(decoded);
+            finalized++;
+            if (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() >= budgetMilliseconds) break;
+        }
+    }
+    EvictToBudget();
+    return finalized;
+}
+
+void ResourceManager::SetMemoryBudget(size_t bytes) {
+    memoryBudget = bytes;
+}
+
+ResourceStats ResourceManager::GetStats() const {
+    ResourceStats result = stats;
+    result.residentBytes = atlas.GetResidentBytes() + residentSoundBytes;
+    result.memoryBudget = memoryBudget;
+    for (const TextureEntry& entry : textures)
+        if (entry.state == AssetState::Resident) result.residentTextures++;
+    for (const SoundEntry& entry : sounds)
+        if (entry.state == AssetState::Resident) result.residentSounds++;
+    return result;
+}
+
+bool ResourceManager::IsLoading() const {
+    return GetPendingCount() > 0;
+}
+
+size_t ResourceManager::GetPendingCount() const {
+    return loader ? loader->GetPendingCount() : 0;
+}
+
+bool ResourceManager::IsHeadless() const {
+    return headless;
+}
+
+const TextureAtlas& ResourceManager::GetAtlas() const {
+    return atlas;
+}
+
+// Sprites may still hold handles, and Release them later, so the paths and reference counts stay
 void ResourceManager::UnloadAll() {
-    for (auto& [key, texture] : textures) UnloadTexture(texture);
-    for (auto& [key, sound] : sounds) UnloadSound(sound);
-    textures.clear();
-    sounds.clear();
+    if (loader) loader->CancelAll();
+    for (SoundEntry& entry : sounds) {
+        if (entry.ownsSound) UnloadSound(entry.sound);
+        entry.sound = {};
+        entry.ownsSound = false;
+        entry.bytes = 0;
+        entry.state = AssetState::Unloaded;
+        entry.evictable = false;
+    }
+    for (TextureEntry& entry : textures) {
+        entry.region = {};
+        entry.state = AssetState::Unloaded;
+        entry.evictable = false;
+    }
+    atlas.Clear();
+    evictionOrder.clear();
+    residentSoundBytes = 0;
+    placeholderTexture = {};
 }
 
 ResourceManager::~ResourceManager() {
@@ -1,23 +1,164 @@
 #pragma once
 #include "raylib.h"
+#include <list>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <memory>
-#include <fstream>
-#include <filesystem>
+#include <vector>
+#include "TextureAtlas.h"
+#include "AssetLoader.h"
+#include "ResourceHandle.h"
+#include "Snapshot.h"
 
+// Everything a sprite looks up by path, resolved once and shared by a whole batch of sprites
+struct SpriteAssets {
+    TextureHandle texture;
+    SoundHandle sound; // Invalid for sprites without a sound
+};
+
+struct ResourceStats {
+    size_t residentBytes = 0; // Atlas pages in use plus loaded sounds
+    size_t memoryBudget = 0;
+    size_t residentTextures = 0;
+    size_t residentSounds = 0;
+    size_t hits = 0;      // Requests for an asset that was resident or already loading
+    size_t misses = 0;    // Requests that started a load
+    size_t evictions = 0;
+};
+
+// Request* returns at once: files are decoded by an AssetLoader, and until Update has uploaded the
+// result a handle resolves to a placeholder texture or the silent default sound. Headless managers
+// load nothing and resolve every handle immediately.
+// Each path is interned once: handles index plain vectors, and the paths are only kept here, for
+// snapshots to save.
+// Sprites Retain the handles they hold and Release them when they go. Assets nothing holds stay
+// cached until resident memory goes over the budget; Update then evicts them, least recently
+// released first. An evicted asset's handle stays valid and loads it again on the next request.
 class ResourceManager {
 private:
-    std::unordered_map<std::string, Texture2D> textures;
-    std::unordered_map<std::string, Sound> sounds;
-    Sound defaultSound;
+    static constexpr int PLACEHOLDER_SIZE = 16;
+
+    // Lets the path maps be searched with a string_view, without building a std::string
+    struct PathHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view path) const { return std::hash<std::string_view>{}(path); }
+    };
+    template <typename Handle>
+    using PathMap = std::unordered_map<std::string, Handle, PathHash, std::equal_to<>>;
+
+    enum class AssetState {
+        Unloaded, // Never requested, or evicted
+        Loading,
+        Resident
+    };
+
+    // Which entry a place in the eviction order stands for
+    struct AssetKey {
+        bool isSound;
+        uint32_t index;
+    };
+
+    struct AssetEntry {
+        AssetState state = AssetState::Unloaded;
+        uint32_t references = 0;
+        size_t bytes = 0;            // Counted into residentSoundBytes for sounds; pages are counted by the atlas
+        bool evictable = false;      // Resident and unreferenced, so it has a place in evictionOrder
+        std::list<AssetKey>::iterator evictionPosition;
+    };
+
+    struct TextureEntry : AssetEntry {
+        AtlasRegion region; // The placeholder unless resident
+    };
+
+    struct SoundEntry : AssetEntry {
+        Sound sound = {};        // Loaded from the file, if there was one
+        bool ownsSound = false;  // False for missing files, which play the default sound
+    };
+
+    // Every texture is a region of an atlas page; each path is packed once, on first use
+    TextureAtlas atlas;
+    PathMap<TextureHandle> textureHandles;
+    std::vector<TextureEntry> textures;
+    std::vector<std::string> texturePaths;
+    PathMap<SoundHandle> soundHandles;
+    std::vector<SoundEntry> sounds;
+    std::vector<std::string> soundPaths;
+    // By snapshot string index, the handle that string was last resolved to. Checked against the
+    // path before use, so it holds across snapshots with different string tables.
+    std::vector<TextureHandle> texturesBySnapshotString;
+    std::vector<SoundHandle> soundsBySnapshotString;
+    AtlasRegion placeholderTexture;
+    // Silent and owns no audio buffer, so it is never unloaded; entries only unload what they loaded
+    Sound defaultSound = {};
+    bool headless;
+    std::unique_ptr<AssetLoader> loader; // Null when headless
+
+    size_t memoryBudget;
+    size_t residentSoundBytes = 0;
+    std::list<AssetKey> evictionOrder; // Least recently released at the front
+    ResourceStats stats;
+
+    const AtlasRegion& GetPlaceholderTexture();
+    TextureHandle Acquire(TextureHandle handle, int width, int height);
+    SoundHandle Acquire(SoundHandle handle);
+    void StartLoading(TextureHandle handle, int width, int height);
+    void StartLoading(SoundHandle handle);
+    void Finalize(AssetLoader::Decoded& decoded);
+    AssetEntry& GetEntry(AssetKey key);
+    void BecomeResident(AssetEntry& entry, AssetKey key);
+    void Retain(AssetEntry& entry);
+    void Release(AssetEntry& entry, AssetKey key);
+    void Evict(AssetKey key);
+    void EvictToBudget();
 
 public:
-    ResourceManager();
-    Texture2D GetTexture(const std::string& path, int width = 100, int height = 100);
-    Sound GetSound(const std::string& path);
-    void SaveResourceKey(std::ofstream& file, const std::string& path);
-    std::string LoadResourceKey(std::ifstream& file);
+    static constexpr double DEFAULT_UPLOAD_BUDGET_MILLISECONDS = 4.0;
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 256u * 1024 * 1024;
+
+    ResourceManager(bool headless = false, size_t memoryBudget = DEFAULT_MEMORY_BUDGET);
+    ResourceManager(const ResourceManager&) = delete;
+    ResourceManager& operator=(const ResourceManager&) = delete;
+    TextureHandle RequestTexture(std::string_view path, int width = 100, int height = 100);
+    // An empty path gives the invalid handle, which plays the default sound
+    SoundHandle RequestSound(std::string_view path);
+    SpriteAssets GetSpriteAssets(std::string_view texturePath, std::string_view soundPath, int width = 100, int height = 100);
+
+    // For Sprite::Load: the path at index in a snapshot's string table, without hashing it when the
+    // same index was resolved to the same path before
+    TextureHandle RequestTexture(const SnapshotStringTable& strings, uint32_t index, int width = 100, int height = 100);
+    SoundHandle RequestSound(const SnapshotStringTable& strings, uint32_t index);
+
+    const std::string& GetTexturePath(TextureHandle handle) const { return texturePaths[handle.index]; }
+    // Empty for the invalid handle
+    const std::string& GetSoundPath(SoundHandle handle) const;
+
+    const AtlasRegion& GetTexture(TextureHandle handle) const { return textures[handle.index].region; }
+    // False while GetTexture still gives the placeholder
+    bool IsLoaded(TextureHandle handle) const { return textures[handle.index].state == AssetState::Resident; }
+    const Sound& GetSound(SoundHandle handle) const {
+        if (!handle.IsValid() || !sounds[handle.index].ownsSound) return defaultSound;
+        return sounds[handle.index].sound;
+    }
+
+    // Invalid handles are ignored, so sprites without a sound need no special case
+    void Retain(TextureHandle handle);
+    void Release(TextureHandle handle);
+    void Retain(SoundHandle handle);
+    void Release(SoundHandle handle);
+
+    // Main thread, once a frame: uploads finished decodes until budgetMilliseconds is spent, then
+    // evicts unreferenced assets while over the memory budget. At least one decode is uploaded per
+    // call, so loading always progresses. Returns how many were.
+    size_t Update(double budgetMilliseconds = DEFAULT_UPLOAD_BUDGET_MILLISECONDS);
+    void SetMemoryBudget(size_t bytes);
+    ResourceStats GetStats() const;
+    bool IsLoading() const;
+    size_t GetPendingCount() const;
+
+    bool IsHeadless() const;
+    const TextureAtlas& GetAtlas() const;
+    // Frees every texture and sound. Handles stay valid, and reload their asset when requested again.
     void UnloadAll();
     ~ResourceManager();
 };
@@ -0,0 +1,104 @@
+#include "RewindBuffer.h"
+#include <algorithm>
+
+RewindBuffer::RewindBuffer(uint32_t capacityTicks, uint32_t keyframeInterval)
+    : capacityTicks(std::max(capacityTicks, 1u)), keyframeInterval(std::max(keyframeInterval, 1u)) {}
+
+void RewindBuffer::Record(uint64_t tick) {
+    if (!frames.empty() && tick <= frames.back().tick) {
+        size_t index = std::lower_bound(frames.begin(), frames.end(), tick,
+            [](const Frame& frame, uint64_t value) { return frame.tick < value; }) - frames.begin();
+        DropFramesFrom(index);
+        if (!frames.empty()) Reconstruct(frames.back().tick, newestSnapshot);
+    }
+
+    bool keyframe = frames.empty() || ticksSinceKeyframe + 1 >= keyframeInterval ||
+        !Snapshot::CanEncodeDelta(newestSnapshot, captureBuffer);
+
+    if (keyframe) Snapshot::Encode(captureBuffer, encodeScratch);
+    else Snapshot::EncodeDelta(newestSnapshot, captureBuffer, encodeScratch);
+
+    // Copied out at the exact size, so recorded frames hold no spare capacity
+    frames.push_back({ tick, keyframe, std::vector<uint8_t>(encodeScratch.begin(), encodeScratch.end()) });
+    ticksSinceKeyframe = keyframe ? 0 : ticksSinceKeyframe + 1;
+    std::swap(newestSnapshot, captureBuffer);
+
+    EvictOldGroups();
+}
+
+bool RewindBuffer::Reconstruct(uint64_t tick, SnapshotData& snapshot) const {
+    size_t target = FindFrame(tick);
+    if (target == frames.size()) return false;
+
+    size_t keyframe = target;
+    while (!frames[keyframe].keyframe) --keyframe;
+
+    const Frame& base = frames[keyframe];
+    Snapshot::Decode(base.bytes.data(), base.bytes.size(), snapshot);
+    for (size_t i = keyframe + 1; i <= target; ++i)
+        Snapshot::ApplyDelta(frames[i].bytes.data(), frames[i].bytes.size(), snapshot);
+    return true;
+}
+
+const SnapshotData* RewindBuffer::Rewind(uint64_t tick) {
+    size_t target = FindFrame(tick);
+    if (target == frames.size()) return nullptr;
+
+    DropFramesFrom(target + 1);
+    Reconstruct(tick, newestSnapshot);
+    return &newestSnapshot;
+}
+
+void RewindBuffer::Clear() {
+    frames.clear();
+    newestSnapshot.Clear();
+    ticksSinceKeyframe = 0;
+}
+
+size_t RewindBuffer::GetKeyframeCount() const {
+    return std::count_if(frames.begin(), frames.end(), [](const Frame& frame) { return frame.keyframe; });
+}
+
+size_t RewindBuffer::GetMemoryBytes() const {
+    size_t bytes = 0;
+    for (const Frame& frame : frames) bytes += sizeof(Frame) + frame.bytes.capacity();
+    return bytes;
+}
+
+size_t RewindBuffer::GetKeyframeBytes() const {
+    size_t bytes = 0;
+    for (const Frame& frame : frames) if (frame.keyframe) bytes += frame.bytes.size();
+    return bytes;
+}
+
+size_t RewindBuffer::GetDeltaBytes() const {
+    size_t bytes = 0;
+    for (const Frame& frame : frames) if (!frame.keyframe) bytes += frame.bytes.size();
+    return bytes;
+}
+
+size_t RewindBuffer::FindFrame(uint64_t tick) const {
+    auto found = std::lower_bound(frames.begin(), frames.end(), tick,
+        [](const Frame& frame, uint64_t value) { return frame.tick < value; });
+    if (found == frames.end() || found->tick != tick) return frames.size();
+    return found - frames.begin();
+}
+
+void RewindBuffer::DropFramesFrom(size_t index) {
+    frames.erase(frames.begin() + index, frames.end());
+
+    ticksSinceKeyframe = 0;
+    for (size_t i = frames.size(); i > 0 && !frames[i - 1].keyframe; --i) ++ticksSinceKeyframe;
+}
+
+// The front group can go once the next keyframe alone still reaches capacityTicks back
+void RewindBuffer::EvictOldGroups() {
+    while (true) {
+        size_t nextKeyframe = 1;
+        while (nextKeyframe < frames.size() && !frames[nextKeyframe].keyframe) ++nextKeyframe;
+        if (nextKeyframe == frames.size()) return;
+        if (frames.back().tick - frames[nextKeyframe].tick + 1 < capacityTicks) return;
+
+        frames.erase(frames.begin(), frames.begin() + nextKeyframe);
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "Snapshot.h"
+
+// Rolling history of the last capacityTicks simulation ticks for rewinding. Every
+// keyframeInterval-th tick, and any tick whose structure differs from the one before (entities
+// added or removed, new resource paths), is stored as a full encoded snapshot. All other ticks are
+// deltas against the tick before them. Reaching a tick decodes its keyframe and applies at most
+// keyframeInterval - 1 deltas. History is dropped one keyframe group at a time, so the buffer always
+// covers at least capacityTicks once it is full.
+class RewindBuffer {
+public:
+    static const uint32_t DEFAULT_KEYFRAME_INTERVAL = 60;
+
+    RewindBuffer(uint32_t capacityTicks, uint32_t keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+
+    // Fill with GameState::CaptureSnapshot, then Record it as the state after tick. Recording a tick
+    // that is not newer than the newest one first drops it and everything after it.
+    SnapshotData& GetCaptureBuffer() { return captureBuffer; }
+    void Record(uint64_t tick);
+
+    // Rebuilds the state recorded for tick; false if it is not (or no longer) in the buffer
+    bool Reconstruct(uint64_t tick, SnapshotData& snapshot) const;
+    // Reconstructs tick and drops everything recorded after it, so recording carries on from there
+    const SnapshotData* Rewind(uint64_t tick);
+    void Clear();
+
+    bool IsEmpty() const { return frames.empty(); }
+    uint64_t GetOldestTick() const { return frames.empty() ? 0 : frames.front().tick; }
+    uint64_t GetNewestTick() const { return frames.empty() ? 0 : frames.back().tick; }
+    size_t GetFrameCount() const { return frames.size(); }
+    size_t GetKeyframeCount() const;
+    // Heap bytes held by the recorded frames
+    size_t GetMemoryBytes() const;
+    // Encoded sizes only, split by frame kind
+    size_t GetKeyframeBytes() const;
+    size_t GetDeltaBytes() const;
+
+private:
+    struct Frame {
+        uint64_t tick;
+        bool keyframe;
+        std::vector<uint8_t> bytes;
+    };
+
+    uint32_t capacityTicks;
+    uint32_t keyframeInterval;
+    std::deque<Frame> frames;
+    SnapshotData captureBuffer;
+    SnapshotData newestSnapshot; // Delta base for the next Record
+    std::vector<uint8_t> encodeScratch;
+    uint32_t ticksSinceKeyframe = 0;
+
+    // Index of the frame holding tick, or frames.size()
+    size_t FindFrame(uint64_t tick) const;
+    void DropFramesFrom(size_t index);
+    void EvictOldGroups();
+};
@@ -1,8 +1,8 @@
 #pragma once
-#include <fstream>
+#include "Snapshot.h"
 
 struct Saveable {
-    virtual void Save(std::ofstream& file) const = 0;
-    virtual void Load(std::ifstream& file) = 0;
+    virtual void Save(EntityRecord& record, SnapshotStringTable& strings) const = 0;
+    virtual void Load(const EntityRecord& record, const SnapshotStringTable& strings) = 0;
     virtual ~Saveable() = default;
-};
\ No newline at end of file
+};
@@ -1,16 +1,8 @@
 #include "SceneNode.h"
 #include <stdexcept>
-#include "Player.h"
-#include "Background.h"
-#include "Wall.h"
-#include "Platform.h"
-
-enum class SpriteType {
-    PlayerSprite,
-    WallSprite,
-    BackgroundSprite,
-    PlatformSprite
-};
+#include <algorithm>
+#include "ObjectPool.h"
+#include "SpriteRegistry.h"
 
 SceneNode::SceneNode(ResourceManager& resourceManager)
     : resourceManager(resourceManager), sprite(nullptr), parent(nullptr) {}
@@ -20,6 +12,7 @@ SceneNode::SceneNode(std::shared_ptr<Sprite> sprite, ResourceManager& resourceMa
 
 void SceneNode::AttachChild(std::shared_ptr<SceneNode> child) {
     child->parent = this;
+    child->MarkTransformDirty();
     children.push_back(std::move(child));
 }
 
@@ -31,6 +24,7 @@ std::shared_ptr<SceneNode> SceneNode::DetachChild(const SceneNode& node) {
 
     std::shared_ptr<SceneNode> result = std::move(*found);
     result->parent = nullptr;
+    result->MarkTransformDirty();
     children.erase(found);
     return result;
 }
@@ -39,156 +33,145 @@ const std::vector<std::shared_ptr<SceneNode>>& SceneNode::GetChildren() const {
     return children;
 }
 
-void SceneNode::Update(float deltaTime, int screenWidth, int screenHeight) {
+void SceneNode::Update(float deltaTime, int screenWidth, int screenHeight, const InputState& input) {
+    if (sprite) sprite->Update(deltaTime, screenWidth, screenHeight, input);
+
+    for (const auto& child : children) child->Update(deltaTime, screenWidth, screenHeight, input);
+}
+
+// Parent positions are projected one step ahead, wall clamp included, so the fused physics kernel
+// constrains children against where their parents will be after this tick's step
+void SceneNode::PropagateParentOffsets(Vector2 parentPosition, float deltaTime, int screenWidth, int screenHeight) {
+    Vector2 globalPosition = parentPosition;
     if (sprite) {
-        sprite->Update(deltaTime, screenWidth, screenHeight);
+        sprite->GetStore().parentOffsets[sprite->GetSlot()] = parentPosition;
+        Vector2 position = PhysicsKernel::ProjectPosition(sprite->Position(), sprite->Velocity(), sprite->Size(), parentPosition,
+            sprite->IsCollidable(), deltaTime, screenWidth, screenHeight);
+        globalPosition = { parentPosition.x + position.x, parentPosition.y + position.y };
+    }
 
-        sprite->position.x += sprite->velocity.x * deltaTime;
-        sprite->position.y += sprite->velocity.y * deltaTime;
+    for (const auto& child : children) child->PropagateParentOffsets(globalPosition, deltaTime, screenWidth, screenHeight);
+}
+
+void SceneNode::UpdateWorldTransform() {
+    Vector2 parentPosition = parent ? parent->globalPosition : Vector2{ 0, 0 };
+    float parentRotation = parent ? parent->globalRotation : 0.0f;
+
+    if (sprite) {
+        globalPosition = { parentPosition.x + sprite->Position().x, parentPosition.y + sprite->Position().y };
+        globalRotation = parentRotation + sprite->Rotation();
+    }
+    else {
+        globalPosition = parentPosition;
+        globalRotation = parentRotation;
     }
-    if (sprite->collidable) ConstrainToBounds(screenWidth, screenHeight);
+    transformDirty = false;
+
+    for (const auto& child : children) child->UpdateWorldTransform();
+}
 
-    for (const auto& child : children) child->Update(deltaTime, screenWidth, screenHeight);
+void SceneNode::MarkTransformDirty() {
+    transformDirty = true;
+    for (const auto& child : children) child->MarkTransformDirty();
 }
 
-void SceneNode::ConstrainToBounds(int screenWidth, int screenHeight) {
+Vector2 SceneNode::GetInterpolatedPosition(float alpha, uint32_t draw) const {
+    if (interpolatedDraw == draw) return interpolatedPosition;
+
+    Vector2 parentPosition = parent ? parent->GetInterpolatedPosition(alpha, draw) : Vector2{ 0, 0 };
+    interpolatedPosition = parentPosition;
     if (sprite) {
-        float halfWidth = sprite->size.x / 2.0f;
-        float halfHeight = sprite->size.y / 2.0f;
-        auto position = GetGlobalPosition();
-        auto offset_x = position.x - sprite->position.x;
-        auto offset_y = position.y - sprite->position.y;
-
-        if (position.x - halfWidth < 0) {
-            sprite->position.x = halfWidth - offset_x;
-            sprite->velocity.x = -sprite->velocity.x;
-            sprite->OnCollision();
-        }
-        if (position.x + halfWidth > screenWidth) {
-            sprite->position.x = screenWidth - halfWidth - offset_x;
-            sprite->velocity.x = -sprite->velocity.x;
-            sprite->OnCollision();
-        }
-        if (position.y - halfHeight < 0) {
-            sprite->position.y = halfHeight - offset_y;
-            sprite->velocity.y = -sprite->velocity.y;
-            sprite->OnCollision();
-        }
-        if (position.y + halfHeight > screenHeight) {
-            sprite->position.y = screenHeight - halfHeight - offset_y;
-            sprite->velocity.y = -sprite->velocity.y;
-            sprite->OnCollision();
-        }
+        Vector2 localPosition = sprite->GetStore().InterpolatePosition(sprite->GetSlot(), alpha);
+        interpolatedPosition = { parentPosition.x + localPosition.x, parentPosition.y + localPosition.y };
     }
+    interpolatedDraw = draw;
+    return interpolatedPosition;
 }
 
-void SceneNode::Draw() const {
-    auto pos = GetGlobalPosition();
-    if (sprite) sprite->Draw(pos.x, pos.y);
-    for (const auto& child : children) child->Draw();
+void SceneNode::QueueDraw(RenderQueue& queue, float alpha, uint32_t draw) const {
+    if (!sprite) return;
+    float rotation = sprite->GetStore().InterpolateRotation(sprite->GetSlot(), alpha);
+    sprite->QueueDraw(queue, handle.index, GetInterpolatedPosition(alpha, draw), rotation);
+}
+
+void SceneNode::MoveSpriteTo(EntityStore& store) {
+    if (sprite) store.Adopt(*sprite);
+}
+
+bool SceneNode::IsAlwaysVisible() const {
+    return sprite && sprite->IsAlwaysVisible();
 }
 
 bool SceneNode::IsCollidable() const {
-    return sprite->collidable;
+    return sprite->IsCollidable();
 }
 
-Vector2 SceneNode::GetGlobalPosition() const {
-    if (parent) {
-        Vector2 parentPosition = parent->GetGlobalPosition();
-        return { parentPosition.x + sprite->position.x, parentPosition.y + sprite->position.y };
+void SceneNode::RefreshTransform() const {
+    Vector2 parentPosition = parent ? parent->GetGlobalPosition() : Vector2{ 0, 0 };
+    float parentRotation = parent ? parent->GetGlobalRotation() : 0.0f;
+
+    if (sprite) {
+        globalPosition = { parentPosition.x + sprite->Position().x, parentPosition.y + sprite->Position().y };
+        globalRotation = parentRotation + sprite->Rotation();
     }
-    return sprite->position;
+    else {
+        globalPosition = parentPosition;
+        globalRotation = parentRotation;
+    }
+    transformDirty = false;
+}
+
+Vector2 SceneNode::GetGlobalPosition() const {
+    if (transformDirty) RefreshTransform();
+    return globalPosition;
 }
 
 float SceneNode::GetGlobalRotation() const {
-    if (parent) return parent->GetGlobalRotation() + sprite->rotation;
-    return sprite->rotation;
+    if (transformDirty) RefreshTransform();
+    return globalRotation;
 }
 
 Rectangle SceneNode::GetBounds() const {
     Vector2 globalPosition = GetGlobalPosition();
-    return { globalPosition.x - sprite->size.x / 2, globalPosition.y - sprite->size.y / 2, sprite->size.x, sprite->size.y };
+    Vector2 size = sprite->Size();
+    return { globalPosition.x - size.x / 2, globalPosition.y - size.y / 2, size.x, size.y };
 }
 
 ShapeType SceneNode::GetShape() const {
-    return sprite->shape;
+    return sprite->Shape();
 }
 
 Vector2 SceneNode::GetSize() const {
-    return sprite->size;
+    return sprite->Size();
 }
 
 Vector2 SceneNode::GetVelocity() const {
-    return sprite->velocity;
+    return sprite->Velocity();
 }
 
 void SceneNode::SetVelocity(const Vector2& velocity) {
-    sprite->velocity = velocity;
+    sprite->Velocity() = velocity;
 }
 
-void SceneNode::SaveScene(std::ofstream& file) const {
-    size_t childCount = children.size();
-    file.write(reinterpret_cast<const char*>(&childCount), sizeof(childCount));
-
-    for (const auto& child : children) child->SaveScene(file);
-}
+void SceneNode::SaveSnapshot(SnapshotData& snapshot, int32_t parentIndex) const {
+    EntityRecord record = {};
+    record.parent = parentIndex;
+    record.handleIndex = handle.index;
+    record.handleGeneration = handle.generation;
+    record.type = static_cast<uint32_t>(sprite->GetType());
 
-void SceneNode::LoadScene(std::ifstream& file) {
-    size_t childCount;
-    file.read(reinterpret_cast<char*>(&childCount), sizeof(childCount));
+    sprite->Save(record, snapshot.strings);
+    int32_t index = static_cast<int32_t>(snapshot.records.size());
+    snapshot.records.push_back(record);
 
-    for (size_t i = 0; i < childCount; ++i) {
-        auto child = std::make_shared<SceneNode>(resourceManager);
-        child->LoadScene(file); 
-        AttachChild(std::move(child));
-    }
+    for (const auto& child : children) child->SaveSnapshot(snapshot, index);
 }
 
-void SceneNode::SaveSprite(std::ofstream& file) const {
-    if (dynamic_cast<Player*>(sprite.get())) {
-        SpriteType type = SpriteType::PlayerSprite;
-        file.write(reinterpret_cast<const char*>(&type), sizeof(type));
-    }
-    else if (dynamic_cast<Wall*>(sprite.get())) {
-        SpriteType type = SpriteType::WallSprite;
-        file.write(reinterpret_cast<const char*>(&type), sizeof(type));
-    }
-    else if (dynamic_cast<Background*>(sprite.get())) {
-        SpriteType type = SpriteType::BackgroundSprite;
-        file.write(reinterpret_cast<const char*>(&type), sizeof(type));
-    }
-    else if (dynamic_cast<Platform*>(sprite.get())) {
-        SpriteType type = SpriteType::PlatformSprite;
-        file.write(reinterpret_cast<const char*>(&type), sizeof(type));
-    }
-    else {
-        throw std::runtime_error("Unknown sprite type during saving");
-    }
-    sprite->Save(file);
-    for (const auto& child : children) child->SaveSprite(file);
-}
-
-void SceneNode::LoadSprite(std::ifstream& file) {
-    SpriteType type;
-    file.read(reinterpret_cast<char*>(&type), sizeof(type));
-
-    switch (type) {
-    case SpriteType::PlayerSprite:
-        sprite = std::make_shared<Player>(resourceManager, Vector2{ 0, 0 }, Vector2{ 0, 0 });
-        break;
-    case SpriteType::WallSprite:
-        sprite = std::make_shared<Wall>(resourceManager, Vector2{ 0, 0 }, Vector2{ 0, 0 });
-        break;
-    case SpriteType::PlatformSprite:
-        sprite = std::make_shared<Platform>(resourceManager, Vector2{ 0, 0 }, Vector2{ 0, 0 }, Vector2{ 0, 0 });
-        break;
-    case SpriteType::BackgroundSprite:
-        sprite = std::make_shared<Background>(resourceManager);
-        break;
-    default:
-        throw std::runtime_error("Unknown sprite type during loading");
-    }
-
-    sprite->Load(file);
-    for (const auto& child : children) child->LoadSprite(file);
+std::shared_ptr<SceneNode> SceneNode::FromRecord(const EntityRecord& record, const SnapshotStringTable& strings, ResourceManager& resourceManager) {
+    // Created without assets; Load looks up the ones the record names
+    std::shared_ptr<Sprite> sprite = SpriteRegistry::Get(record.type).create(resourceManager, { 0, 0 }, { 0, 0 }, { 0, 0 }, SpriteAssets{});
+    sprite->Load(record, strings);
+    auto node = ObjectPool::MakeShared<SceneNode>(std::move(sprite), resourceManager);
+    node->handle = { record.handleIndex, record.handleGeneration };
+    return node;
 }
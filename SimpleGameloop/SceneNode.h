@@ -1,11 +1,12 @@
 #pragma once
 #include <vector>
 #include <memory>
-#include <fstream>
-#include <filesystem>
 #include "raylib.h"
 #include "Sprite.h"
 #include "ResourceManager.h"
+#include "EntityHandle.h"
+
+class Quadtree;
 
 class SceneNode {
 private:
@@ -13,8 +14,25 @@ private:
     std::vector<std::shared_ptr<SceneNode>> children;
     ResourceManager& resourceManager;
 
+    // World transform cache, rebuilt top-down once per tick by UpdateWorldTransform. Anything that
+    // moves a node outside the tick (re-parenting, loading) marks the subtree dirty so the next
+    // read recomputes it from the parent chain.
+    mutable Vector2 globalPosition = { 0, 0 };
+    mutable float globalRotation = 0.0f;
+    mutable bool transformDirty = true;
+    // Global position blended between the last two ticks, worked out at most once per draw
+    mutable Vector2 interpolatedPosition = { 0, 0 };
+    mutable uint32_t interpolatedDraw = 0;
+
+    void RefreshTransform() const;
+
 public:
+    static const size_t NO_PROXY = static_cast<size_t>(-1);
+
     SceneNode* parent;
+    Quadtree* quadtreeCell = nullptr;
+    size_t broadPhaseProxy = NO_PROXY; // Index of this node's entry in a flat broad phase
+    EntityHandle handle;               // Set by GameState::RegisterEntity
     SceneNode(ResourceManager& resourceManager);
     SceneNode(std::shared_ptr<Sprite> sprite, ResourceManager& resourceManager);
 
@@ -22,9 +40,19 @@ public:
     std::shared_ptr<SceneNode> DetachChild(const SceneNode& node);
     const std::vector<std::shared_ptr<SceneNode>>& GetChildren() const;
 
-    void Update(float deltaTime, int screenWidth, int screenHeight);
-    void ConstrainToBounds(int screenWidth, int screenHeight);
-    void Draw() const;
+    void Update(float deltaTime, int screenWidth, int screenHeight, const InputState& input);
+    void PropagateParentOffsets(Vector2 parentPosition, float deltaTime, int screenWidth, int screenHeight);
+    void UpdateWorldTransform();
+    void MarkTransformDirty();
+    // Global position blended between the previous and the current tick (alpha 1 is the current one).
+    // draw numbers the draw it is for: each node is blended once per draw and its children reuse the
+    // result, so only the visible nodes and their ancestors are touched, each a single time.
+    Vector2 GetInterpolatedPosition(float alpha, uint32_t draw) const;
+    // Queues this node's sprite only, not its children
+    void QueueDraw(RenderQueue& queue, float alpha, uint32_t draw) const;
+    bool IsAlwaysVisible() const;
+    // This node's sprite only, not its children's
+    void MoveSpriteTo(EntityStore& store);
 
     bool IsCollidable() const;
     Vector2 GetGlobalPosition() const;
@@ -36,8 +64,7 @@ public:
     Vector2 GetVelocity() const;
     void SetVelocity(const Vector2& velocity);
 
-    void SaveScene(std::ofstream& file) const;
-    void LoadScene(std::ifstream& file);
-    void SaveSprite(std::ofstream& file) const;
-    void LoadSprite(std::ifstream& file);
+    // Appends this node and its subtree to the snapshot in pre-order
+    void SaveSnapshot(SnapshotData& snapshot, int32_t parentIndex) const;
+    static std::shared_ptr<SceneNode> FromRecord(const EntityRecord& record, const SnapshotStringTable& strings, ResourceManager& resourceManager);
 };
@@ -4,20 +4,71 @@
 #include "Background.h"
 #include <ctime>
 #include "SpriteFactory.h"
+#include "SimulationClock.h"
+#include "InputRecording.h"
+#include <optional>
+#include <chrono>
 
 const int SCREEN_WIDTH = 1000;
 const int SCREEN_HEIGHT = 800;
 const Color BACKGROUND_COLOR = Color{ 255, 239, 213, 255 };
 const Color PAUSED_TEXT_COLOR = Color{ 255, 165, 0, 255 };
 const Color INSTRUCTION_TEXT_COLOR = Color{ 255, 69, 0, 255 };
-const float SUSPICIOUS_DELTA_TIME_THRESHOLD = 0.1f;
 const float MAX_FPS = 60.0f;
-const std::string SCENE_FILE = "scene.dat";
-const std::string SPRITES_FILE = "sprites.dat";
+const float SIMULATION_TICK_RATE = 60.0f;
+const int MAX_CATCH_UP_STEPS = 5;
+const std::string SNAPSHOT_FILE = "snapshot.dat";
+const int REWIND_SECONDS = 10;
+const int REWIND_STEP_SECONDS = 1;
+const std::string INPUT_RECORDING_FILE = "input.rec";
+
+// Times one burst of asset loading, at startup or after loading a saved game, and prints it once the
+// loader has drained. Frame times leave out the wait for the target frame rate.
+struct AssetLoadReport {
+    const char* label = nullptr;
+    std::chrono::steady_clock::time_point start;
+    double firstFrameMilliseconds = -1.0;
+    double worstFrameMilliseconds = 0.0;
+    bool active = false;
+
+    void Begin(const char* reportLabel, std::chrono::steady_clock::time_point startTime) {
+        label = reportLabel;
+        start = startTime;
+        firstFrameMilliseconds = -1.0;
+        worstFrameMilliseconds = 0.0;
+        active = true;
+    }
 
-int main() {
-    int lastSpriteId = -1;
+    void EndFrame(double frameMilliseconds, bool stillLoading) {
+        if (!active) return;
+
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (firstFrameMilliseconds < 0.0) firstFrameMilliseconds = elapsed;
+        worstFrameMilliseconds = std::max(worstFrameMilliseconds, frameMilliseconds);
+        if (stillLoading) return;
+
+        std::cout << label << ": first frame after " << firstFrameMilliseconds << " ms, assets loaded after " << elapsed
+            << " ms, worst frame " << worstFrameMilliseconds << " ms" << std::endl;
+        active = false;
+    }
+};
+
+// Replay a saved recording headlessly with SimpleGameloopBenchmark --mode replay
+static void StopInputRecording(std::optional<InputRecording>& recording) {
+    if (!recording) return;
+
+    try {
+        recording->Save(INPUT_RECORDING_FILE);
+        std::cout << "Recorded " << recording->GetTickCount() << " ticks to " << INPUT_RECORDING_FILE << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error saving input recording: " << e.what() << std::endl;
+    }
+    recording.reset();
+}
 
+int main() {
+    auto programStart = std::chrono::steady_clock::now();
     srand(static_cast<unsigned int>(time(0)));
     InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Game with Scene Graph and Quadtree");
     InitAudioDevice();
@@ -25,36 +76,85 @@ int main() {
     ResourceManager resourceManager;
     GameState gameState(resourceManager, { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT });
 
-    auto backgroundSprites = SpriteFactory::CreateSprites("Background", 1, { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT }, resourceManager);
-    for (auto& sprite : backgroundSprites) lastSpriteId = gameState.RegisterEntity(std::move(sprite));
+    gameState.Spawn({ .type = SpriteType::BackgroundSprite, .bounds = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT } });
 
-    auto playerSprites = SpriteFactory::CreateSprites("Player", 2, { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT / 2}, resourceManager);
-    for (auto& sprite : playerSprites) lastSpriteId = gameState.RegisterEntity(std::move(sprite));
-    int mainSprite = lastSpriteId;
+    std::vector<EntityHandle> players = gameState.Spawn({ .type = SpriteType::PlayerSprite, .count = 2, .bounds = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT / 2 } });
+    EntityHandle mainSprite = players.back();
 
-    //auto wallSprites = SpriteFactory::CreateSprites("Wall", 3, { 0, SCREEN_HEIGHT / 2, SCREEN_WIDTH, SCREEN_HEIGHT / 2}, resourceManager);
-    //for (auto& sprite : wallSprites) lastSpriteId = gameState.RegisterEntity(std::move(sprite));
+    //gameState.Spawn({ .type = SpriteType::WallSprite, .count = 3, .bounds = { 0, SCREEN_HEIGHT / 2, SCREEN_WIDTH, SCREEN_HEIGHT / 2 } });
 
-    auto platformsSprites = SpriteFactory::CreateSprites("Platform", 3, { 0, SCREEN_HEIGHT / 2, SCREEN_WIDTH, SCREEN_HEIGHT / 2}, resourceManager);
-    for (auto& sprite : platformsSprites) lastSpriteId = gameState.RegisterEntity(std::move(sprite));
+    gameState.Spawn({ .type = SpriteType::PlatformSprite, .count = 3, .bounds = { 0, SCREEN_HEIGHT / 2, SCREEN_WIDTH, SCREEN_HEIGHT / 2 },
+        .minVelocity = { 100, 0 }, .maxVelocity = { 100, 0 } });
 
-    auto childrenSprites = SpriteFactory::CreateSprites("Player", 2, { -200, 200, 400, 0 }, resourceManager);
-    for (auto& sprite : childrenSprites) lastSpriteId = gameState.RegisterEntity(std::move(sprite), mainSprite--);
+    gameState.Spawn({ .type = SpriteType::PlayerSprite, .count = 2, .bounds = { -200, 200, 400, 0 } }, mainSprite);
 
     bool isPaused = false;
+    Vector2 pendingWheelMove = { 0, 0 };
     SetTargetFPS(MAX_FPS);
+    SimulationClock simulationClock(SIMULATION_TICK_RATE, MAX_CATCH_UP_STEPS);
+    SnapshotWriter snapshotWriter;
+    RewindBuffer rewindBuffer(static_cast<uint32_t>(REWIND_SECONDS * SIMULATION_TICK_RATE));
+    uint64_t simulationTick = 0;
+    std::optional<InputRecording> inputRecording;
+    gameState.RecordRewindFrame(rewindBuffer, simulationTick);
+    AssetLoadReport loadReport;
+    loadReport.Begin("Startup", programStart);
 
     while (!WindowShouldClose()) {
+        auto frameStart = std::chrono::steady_clock::now();
         if (IsKeyPressed(KEY_P)) isPaused = !isPaused;
 
-        float deltaTime = GetFrameTime();
+        if (!isPaused && IsWindowFocused()) {
+            InputState input = InputState::Poll();
+            // Wheel movement is a delta, not a held state: frames that run no tick keep theirs for
+            // the next tick, and a frame that runs several hands it to the first one only
+            pendingWheelMove.x += input.wheelMove.x;
+            pendingWheelMove.y += input.wheelMove.y;
+            int steps = simulationClock.Advance(GetFrameTime());
+            for (int step = 0; step < steps; ++step) {
+                input.wheelMove = pendingWheelMove;
+                pendingWheelMove = { 0, 0 };
+                gameState.Update(simulationClock.GetTickDuration(), SCREEN_WIDTH, SCREEN_HEIGHT, input);
+                if (inputRecording) inputRecording->Add(input);
+                gameState.RecordRewindFrame(rewindBuffer, ++simulationTick);
+            }
+        }
 
-        if (!isPaused && IsWindowFocused() && !(deltaTime > SUSPICIOUS_DELTA_TIME_THRESHOLD)) {
-            gameState.Update(deltaTime, SCREEN_WIDTH, SCREEN_HEIGHT);
+        if (IsKeyPressed(KEY_ZERO) && !gameState.SaveGameStateAsync(snapshotWriter, SNAPSHOT_FILE))
+            std::cerr << "Previous save is still in progress." << std::endl;
+        if (auto saveResult = snapshotWriter.PollResult(); saveResult && !saveResult->succeeded)
+            std::cerr << "Error saving game state: " << saveResult->error << std::endl;
+        if (IsKeyPressed(KEY_TWO)) {
+            if (inputRecording) StopInputRecording(inputRecording);
+            else {
+                SnapshotData startState;
+                gameState.CaptureSnapshot(startState);
+                inputRecording.emplace(SIMULATION_TICK_RATE, SCREEN_WIDTH, SCREEN_HEIGHT, startState);
+            }
+        }
+        // Loading and rewinding jump away from the recorded timeline, so they end the recording
+        if (IsKeyPressed(KEY_ONE)) {
+            StopInputRecording(inputRecording);
+            // Load whatever was saved last, even if it is still being written
+            snapshotWriter.Wait();
+            loadReport.Begin("Load", std::chrono::steady_clock::now());
+            gameState.LoadGameState(SNAPSHOT_FILE);
+            simulationClock.Reset();
+            rewindBuffer.Clear();
+            gameState.RecordRewindFrame(rewindBuffer, simulationTick);
+        }
+        if (IsKeyPressed(KEY_R)) {
+            StopInputRecording(inputRecording);
+            uint64_t rewindTicks = static_cast<uint64_t>(REWIND_STEP_SECONDS * SIMULATION_TICK_RATE);
+            uint64_t targetTick = std::max(rewindBuffer.GetOldestTick(), simulationTick > rewindTicks ? simulationTick - rewindTicks : 0);
+            if (gameState.RewindTo(rewindBuffer, targetTick)) {
+                simulationTick = targetTick;
+                simulationClock.Reset();
+            }
         }
 
-        if (IsKeyPressed(KEY_ZERO)) gameState.SaveGameState(SCENE_FILE, SPRITES_FILE);
-        if (IsKeyPressed(KEY_ONE)) gameState.LoadGameState(SCENE_FILE, SPRITES_FILE);
+        // Textures and sounds decoded since the last frame go to the GPU and audio device, a few ms' worth at a time
+        resourceManager.Update();
 
         BeginDrawing();
         ClearBackground(BACKGROUND_COLOR);
@@ -63,14 +163,25 @@ int main() {
             DrawText("PAUSED", SCREEN_WIDTH / 2 - 50, SCREEN_HEIGHT / 2 - 10, 20, PAUSED_TEXT_COLOR);
         }
         else {
-            gameState.Draw();
+            gameState.Draw(simulationClock.GetAlpha(), { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT });
             DrawText("Use WASD to control speed, P to pause.", 10, 10, 20, INSTRUCTION_TEXT_COLOR);
-            DrawText("Press 0 to Save, 1 to Load.", 10, 30, 20, INSTRUCTION_TEXT_COLOR);
+            DrawText("Press 0 to Save, 1 to Load, R to rewind.", 10, 30, 20, INSTRUCTION_TEXT_COLOR);
+            DrawText(inputRecording ? "Recording input, press 2 to stop." : "Press 2 to record input.", 10, 50, 20, INSTRUCTION_TEXT_COLOR);
+            const RenderStats& renderStats = gameState.GetLastRenderStats();
+            DrawText(TextFormat("Drawn: %zu sprites, %zu quads, %zu batches",
+                renderStats.visibleNodes, renderStats.quads, renderStats.batches), 10, 70, 20, INSTRUCTION_TEXT_COLOR);
+            ResourceStats resourceStats = resourceManager.GetStats();
+            DrawText(TextFormat("Assets: %.1f MB resident, %zu hits, %zu misses, %zu evictions",
+                resourceStats.residentBytes / (1024.0 * 1024.0), resourceStats.hits, resourceStats.misses, resourceStats.evictions), 10, 90, 20, INSTRUCTION_TEXT_COLOR);
+            if (resourceManager.IsLoading())
+                DrawText(TextFormat("Loading %zu assets...", resourceManager.GetPendingCount()), 10, 110, 20, INSTRUCTION_TEXT_COLOR);
         }
 
+        loadReport.EndFrame(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count(), resourceManager.IsLoading());
         EndDrawing();
     }
 
+    StopInputRecording(inputRecording);
     resourceManager.UnloadAll();
     CloseWindow();
     return 0;
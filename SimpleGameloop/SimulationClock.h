@@ -0,0 +1,52 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+// Accumulator that turns variable frame times into a whole number of fixed simulation ticks.
+// Time that would need more than maxStepsPerFrame ticks to catch up is dropped, so a long hitch
+// slows the game down for a moment instead of stalling it further. The fraction of a tick left in
+// the accumulator is the interpolation factor for rendering between the last two ticks.
+class SimulationClock {
+public:
+    static constexpr float DEFAULT_TICK_RATE = 60.0f;
+    static const int DEFAULT_MAX_STEPS_PER_FRAME = 5;
+
+private:
+    float tickDuration;
+    int maxStepsPerFrame;
+    double accumulator = 0.0;
+    uint64_t tickCount = 0;
+
+public:
+    SimulationClock(float tickRate = DEFAULT_TICK_RATE, int maxStepsPerFrame = DEFAULT_MAX_STEPS_PER_FRAME)
+        : tickDuration(1.0f / tickRate), maxStepsPerFrame(maxStepsPerFrame) {}
+
+    // Adds one frame of real time and returns how many ticks to simulate now
+    int Advance(float frameTime) {
+        if (frameTime > 0.0f) accumulator += frameTime;
+
+        int steps = 0;
+        while (accumulator >= tickDuration && steps < maxStepsPerFrame) {
+            accumulator -= tickDuration;
+            ++steps;
+        }
+        // Past the cap, the whole ticks left over are dropped on purpose: catching up on them would
+        // make the next frame longer still. The fraction of a tick is kept, so interpolation stays smooth.
+        if (steps == maxStepsPerFrame && accumulator >= tickDuration) accumulator = std::fmod(accumulator, static_cast<double>(tickDuration));
+
+        tickCount += steps;
+        return steps;
+    }
+
+    void Reset() {
+        accumulator = 0.0;
+    }
+
+    float GetTickDuration() const { return tickDuration; }
+    float GetTickRate() const { return 1.0f / tickDuration; }
+    void SetTickRate(float tickRate) { tickDuration = 1.0f / tickRate; }
+    uint64_t GetTickCount() const { return tickCount; }
+
+    // How far rendering is between the previous tick (0) and the latest one (1)
+    float GetAlpha() const { return static_cast<float>(accumulator / tickDuration); }
+};
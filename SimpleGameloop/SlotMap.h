@@ -0,0 +1,132 @@
+#pragma once
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include "EntityHandle.h"
+
+// Values addressed by generational handles. Lookup is two array reads; the values themselves are
+// kept packed in insertion order, and removing one moves the last value into its place, so the
+// order only ever changes where something was removed. Generations come from one counter for the
+// whole map, so a handle is never handed out twice, not even across a restore.
+template <typename T>
+class SlotMap {
+private:
+    struct Slot {
+        uint32_t denseIndex;
+        uint32_t generation;
+        bool occupied;
+    };
+
+    std::vector<T> values;
+    std::vector<uint32_t> denseToSlot;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots; // Popped from the back
+    uint32_t nextGeneration = 0;     // Above every generation handed out so far
+
+    void Occupy(uint32_t slotIndex, T value) {
+        Slot& slot = slots[slotIndex];
+        slot.denseIndex = static_cast<uint32_t>(values.size());
+        slot.occupied = true;
+        values.push_back(std::move(value));
+        denseToSlot.push_back(slotIndex);
+    }
+
+public:
+    EntityHandle Insert(T value) {
+        uint32_t slotIndex;
+        if (!freeSlots.empty()) {
+            slotIndex = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else {
+            slotIndex = static_cast<uint32_t>(slots.size());
+            slots.push_back({ 0, nextGeneration++, false });
+        }
+
+        Occupy(slotIndex, std::move(value));
+        return { slotIndex, slots[slotIndex].generation };
+    }
+
+    // Puts value under exactly this handle, for rebuilding a map from saved handles. Call
+    // FinishRestore once every value is back.
+    void InsertAt(EntityHandle handle, T value) {
+        if (handle.index >= EntityHandle::MAX_INDEX) throw std::runtime_error("Entity handle out of range");
+        if (handle.index >= slots.size()) slots.resize(handle.index + 1, { 0, 0, false });
+        if (slots[handle.index].occupied) throw std::runtime_error("Two entities share a handle");
+
+        slots[handle.index].generation = handle.generation;
+        nextGeneration = std::max(nextGeneration, handle.generation + 1);
+        Occupy(handle.index, std::move(value));
+    }
+
+    // minimumGeneration must be above every handle that may still be around: the saved map's
+    // GetNextGeneration() and that of the map being replaced. Empty slots move past all of them, and
+    // the free slots are lined up lowest index first.
+    void FinishRestore(uint32_t minimumGeneration) {
+        nextGeneration = std::max(nextGeneration, minimumGeneration);
+        freeSlots.clear();
+        for (uint32_t i = static_cast<uint32_t>(slots.size()); i > 0; --i) {
+            if (slots[i - 1].occupied) continue;
+            slots[i - 1].generation = nextGeneration;
+            freeSlots.push_back(i - 1);
+        }
+        if (!freeSlots.empty()) nextGeneration++;
+    }
+
+    bool Remove(EntityHandle handle) {
+        if (!Contains(handle)) return false;
+
+        Slot& slot = slots[handle.index];
+        uint32_t hole = slot.denseIndex;
+        uint32_t last = static_cast<uint32_t>(values.size() - 1);
+        if (hole != last) {
+            values[hole] = std::move(values[last]);
+            denseToSlot[hole] = denseToSlot[last];
+            slots[denseToSlot[hole]].denseIndex = hole;
+        }
+        values.pop_back();
+        denseToSlot.pop_back();
+
+        slot.occupied = false;
+        slot.generation = nextGeneration++;
+        freeSlots.push_back(handle.index);
+        return true;
+    }
+
+    bool Contains(EntityHandle handle) const {
+        return handle.index < slots.size() && slots[handle.index].occupied && slots[handle.index].generation == handle.generation;
+    }
+
+    T* Get(EntityHandle handle) {
+        return Contains(handle) ? &values[slots[handle.index].denseIndex] : nullptr;
+    }
+
+    const T* Get(EntityHandle handle) const {
+        return Contains(handle) ? &values[slots[handle.index].denseIndex] : nullptr;
+    }
+
+    EntityHandle GetHandle(size_t denseIndex) const {
+        uint32_t slotIndex = denseToSlot[denseIndex];
+        return { slotIndex, slots[slotIndex].generation };
+    }
+
+    uint32_t GetNextGeneration() const { return nextGeneration; }
+    size_t Size() const { return values.size(); }
+    bool Empty() const { return values.empty(); }
+
+    // Room for count values in total. Grows at least geometrically, so reserving ahead of many
+    // small batches stays linear.
+    void Reserve(size_t count) {
+        if (count <= values.capacity()) return;
+        count = std::max(count, values.capacity() * 2);
+        values.reserve(count);
+        denseToSlot.reserve(count);
+        slots.reserve(count);
+    }
+
+    // Iterates the packed values
+    typename std::vector<T>::iterator begin() { return values.begin(); }
+    typename std::vector<T>::iterator end() { return values.end(); }
+    typename std::vector<T>::const_iterator begin() const { return values.begin(); }
+    typename std::vector<T>::const_iterator end() const { return values.end(); }
+};
@@ -0,0 +1,301 @@
+#include "Snapshot.h"
+#include "BinaryIO.h"
+#include "EntityHandle.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const uint32_t FNV_OFFSET_BASIS = 2166136261u;
+    const uint32_t FNV_PRIME = 16777619u;
+    const size_t MAX_WRITE_CHUNK = 1u << 30;
+
+    const size_t RECORD_WORDS = sizeof(EntityRecord) / sizeof(uint32_t);
+
+    void SwapRecordWords(EntityRecord* records, size_t count) {
+        if constexpr (std::endian::native == std::endian::little) return;
+
+        uint32_t* words = reinterpret_cast<uint32_t*>(records);
+        for (size_t i = 0; i < count * sizeof(EntityRecord) / sizeof(uint32_t); ++i) words[i] = ToLittleEndian(words[i]);
+    }
+}
+
+// Neighbouring sprites mostly share their paths, so a few string compares usually beat hashing
+uint32_t SnapshotStringTable::Intern(const std::string& value) {
+    for (uint32_t index : recentIndices)
+        if (index < strings.size() && strings[index] == value) return index;
+
+    uint32_t index;
+    auto found = indices.find(value);
+    if (found != indices.end()) index = found->second;
+    else {
+        index = static_cast<uint32_t>(strings.size());
+        strings.push_back(value);
+        indices.emplace(value, index);
+    }
+
+    recentIndices[nextRecent] = index;
+    nextRecent = (nextRecent + 1) % RECENT_COUNT;
+    return index;
+}
+
+void SnapshotStringTable::Append(std::string value) {
+    indices.emplace(value, static_cast<uint32_t>(strings.size()));
+    strings.push_back(std::move(value));
+}
+
+const std::string& SnapshotStringTable::Get(uint32_t index) const {
+    if (index >= strings.size()) throw std::runtime_error("Snapshot string index out of range");
+    return strings[index];
+}
+
+void SnapshotStringTable::Clear() {
+    recentIndices.fill(EntityRecord::NO_STRING);
+    strings.clear();
+    indices.clear();
+}
+
+uint32_t Snapshot::Checksum(const uint8_t* data, size_t size) {
+    uint32_t hash = FNV_OFFSET_BASIS;
+    size_t i = 0;
+    for (; i + sizeof(uint32_t) <= size; i += sizeof(uint32_t)) hash = (hash ^ GetWord(data + i)) * FNV_PRIME;
+    for (; i < size; ++i) hash = (hash ^ data[i]) * FNV_PRIME;
+    return hash;
+}
+
+void Snapshot::Encode(const SnapshotData& snapshot, std::vector<uint8_t>& buffer) {
+    const auto& strings = snapshot.strings.GetStrings();
+    size_t recordBytes = snapshot.records.size() * sizeof(EntityRecord);
+    size_t stringBytes = 0;
+    for (const auto& value : strings) stringBytes += sizeof(uint32_t) + value.size();
+
+    buffer.resize(HEADER_SIZE + recordBytes + stringBytes);
+    uint8_t* header = buffer.data();
+    uint8_t* records = header + HEADER_SIZE;
+    uint8_t* cursor = records + recordBytes;
+
+    if (recordBytes > 0) std::memcpy(records, snapshot.records.data(), recordBytes);
+    SwapRecordWords(reinterpret_cast<EntityRecord*>(records), snapshot.records.size());
+
+    for (const auto& value : strings) {
+        PutWord(cursor, static_cast<uint32_t>(value.size()));
+        if (!value.empty()) std::memcpy(cursor + sizeof(uint32_t), value.data(), value.size());
+        cursor += sizeof(uint32_t) + value.size();
+    }
+
+    PutWord(header + 0, MAGIC);
+    PutWord(header + 4, VERSION);
+    PutWord(header + 8, HEADER_SIZE);
+    PutWord(header + 12, static_cast<uint32_t>(snapshot.records.size()));
+    PutWord(header + 16, static_cast<uint32_t>(strings.size()));
+    PutWord(header + 20, static_cast<uint32_t>(stringBytes));
+    PutWord(header + 24, snapshot.nextGeneration);
+    PutWord(header + 28, Checksum(records, buffer.size() - HEADER_SIZE));
+}
+
+void Snapshot::Decode(const uint8_t* data, size_t size, SnapshotView& view) {
+    if (size < HEADER_SIZE || GetWord(data) != MAGIC) throw std::runtime_error("Not a snapshot file");
+
+    uint32_t version = GetWord(data + 4);
+    if (version != VERSION)
+        throw std::runtime_error("Unsupported snapshot version " + std::to_string(version) + ", expected " + std::to_string(VERSION));
+
+    uint32_t headerSize = GetWord(data + 8);
+    uint64_t recordCount = GetWord(data + 12);
+    uint32_t stringCount = GetWord(data + 16);
+    uint64_t stringBytes = GetWord(data + 20);
+    uint64_t recordBytes = recordCount * sizeof(EntityRecord);
+
+    // Checked before the checksum so a truncated file fails without reading it all
+    if (headerSize != HEADER_SIZE || HEADER_SIZE + recordBytes + stringBytes != size)
+        throw std::runtime_error("Snapshot sections do not match the file size");
+    if (Checksum(data + HEADER_SIZE, size - HEADER_SIZE) != GetWord(data + 28))
+        throw std::runtime_error("Snapshot checksum mismatch");
+
+    SnapshotStringTable strings;
+    const uint8_t* cursor = data + HEADER_SIZE + recordBytes;
+    const uint8_t* end = data + size;
+    for (uint32_t i = 0; i < stringCount; ++i) {
+        if (end - cursor < static_cast<ptrdiff_t>(sizeof(uint32_t))) throw std::runtime_error("Snapshot string table is truncated");
+        uint32_t length = GetWord(cursor);
+        cursor += sizeof(uint32_t);
+        if (static_cast<size_t>(end - cursor) < length) throw std::runtime_error("Snapshot string table is truncated");
+
+        strings.Append(std::string(reinterpret_cast<const char*>(cursor), length));
+        cursor += length;
+    }
+    if (cursor != end) throw std::runtime_error("Snapshot string table has trailing bytes");
+
+    const uint8_t* recordData = data + HEADER_SIZE;
+    std::vector<EntityRecord> ownedRecords;
+    std::span<const EntityRecord> records;
+    bool aligned = reinterpret_cast<uintptr_t>(recordData) % alignof(EntityRecord) == 0;
+    if (std::endian::native == std::endian::little && aligned) {
+        records = { reinterpret_cast<const EntityRecord*>(recordData), static_cast<size_t>(recordCount) };
+    }
+    else {
+        ownedRecords.resize(recordCount);
+        if (recordBytes > 0) std::memcpy(ownedRecords.data(), recordData, recordBytes);
+        SwapRecordWords(ownedRecords.data(), ownedRecords.size());
+        records = ownedRecords;
+    }
+
+    for (size_t i = 0; i < records.size(); ++i) {
+        const EntityRecord& record = records[i];
+        if (record.parent < -1 || record.parent >= static_cast<int64_t>(i))
+            throw std::runtime_error("Snapshot record " + std::to_string(i) + " has an invalid parent");
+        if (record.handleIndex >= EntityHandle::MAX_INDEX)
+            throw std::runtime_error("Snapshot record " + std::to_string(i) + " has an invalid handle");
+        if ((record.texture != EntityRecord::NO_STRING && record.texture >= stringCount) ||
+            (record.sound != EntityRecord::NO_STRING && record.sound >= stringCount))
+            throw std::runtime_error("Snapshot record " + std::to_string(i) + " references a missing string");
+    }
+
+    // Moving the vector keeps its heap block, so records stays valid
+    view.ownedRecords = std::move(ownedRecords);
+    view.records = records;
+    view.strings = std::move(strings);
+    view.nextGeneration = GetWord(data + 24);
+}
+
+void Snapshot::Decode(const uint8_t* data, size_t size, SnapshotData& snapshot) {
+    SnapshotView view;
+    Decode(data, size, view);
+
+    snapshot.records.assign(view.records.begin(), view.records.end());
+    snapshot.strings = std::move(view.strings);
+    snapshot.nextGeneration = view.nextGeneration;
+}
+
+bool Snapshot::CanEncodeDelta(const SnapshotData& base, const SnapshotData& snapshot) {
+    return base.records.size() == snapshot.records.size() &&
+        base.strings.GetStrings() == snapshot.strings.GetStrings();
+}
+
+void Snapshot::EncodeDelta(const SnapshotData& base, const SnapshotData& snapshot, std::vector<uint8_t>& buffer) {
+    buffer.clear();
+    PutVarint(buffer, static_cast<uint32_t>(snapshot.records.size()));
+    PutVarint(buffer, snapshot.nextGeneration - base.nextGeneration);
+
+    uint32_t skipped = 0;
+    for (size_t i = 0; i < snapshot.records.size(); ++i) {
+        if (std::memcmp(&base.records[i], &snapshot.records[i], sizeof(EntityRecord)) == 0) {
+            ++skipped;
+            continue;
+        }
+
+        uint32_t baseWords[RECORD_WORDS];
+        uint32_t words[RECORD_WORDS];
+        std::memcpy(baseWords, &base.records[i], sizeof(EntityRecord));
+        std::memcpy(words, &snapshot.records[i], sizeof(EntityRecord));
+
+        uint32_t mask = 0;
+        for (size_t word = 0; word < RECORD_WORDS; ++word)
+            if (words[word] != baseWords[word]) mask |= 1u << word;
+
+        PutVarint(buffer, skipped);
+        PutVarint(buffer, mask);
+        for (size_t word = 0; word < RECORD_WORDS; ++word)
+            if (mask & (1u << word)) PutVarint(buffer, words[word] ^ baseWords[word]);
+        skipped = 0;
+    }
+}
+
+void Snapshot::ApplyDelta(const uint8_t* data, size_t size, SnapshotData& snapshot) {
+    const uint8_t* cursor = data;
+    const uint8_t* end = data + size;
+
+    if (GetVarint(cursor, end) != snapshot.records.size()) throw std::runtime_error("Snapshot delta was encoded against a different base");
+    snapshot.nextGeneration += GetVarint(cursor, end);
+
+    size_t index = 0;
+    while (cursor != end) {
+        index += GetVarint(cursor, end);
+        uint32_t mask = GetVarint(cursor, end);
+        if (index >= snapshot.records.size() || mask >> RECORD_WORDS) throw std::runtime_error("Snapshot delta is corrupt");
+
+        uint32_t words[RECORD_WORDS];
+        std::memcpy(words, &snapshot.records[index], sizeof(EntityRecord));
+        for (size_t word = 0; word < RECORD_WORDS; ++word)
+            if (mask & (1u << word)) words[word] ^= GetVarint(cursor, end);
+        std::memcpy(&snapshot.records[index], words, sizeof(EntityRecord));
+        ++index;
+    }
+}
+
+#ifdef _WIN32
+void Snapshot::WriteFile(const std::string& path, const std::vector<uint8_t>& buffer) {
+    std::string temporaryPath = path + ".tmp";
+    HANDLE file = CreateFileA(temporaryPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("Failed to open snapshot file for saving.");
+
+    bool written = true;
+    size_t offset = 0;
+    while (written && offset < buffer.size()) {
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(buffer.size() - offset, MAX_WRITE_CHUNK));
+        DWORD chunkWritten = 0;
+        written = ::WriteFile(file, buffer.data() + offset, chunk, &chunkWritten, nullptr) && chunkWritten == chunk;
+        offset += chunkWritten;
+    }
+    written = written && FlushFileBuffers(file);
+    CloseHandle(file);
+
+    if (!written || !MoveFileExA(temporaryPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        DeleteFileA(temporaryPath.c_str());
+        throw std::runtime_error("Failed to write snapshot file.");
+    }
+}
+#else
+void Snapshot::WriteFile(const std::string& path, const std::vector<uint8_t>& buffer) {
+    std::string temporaryPath = path + ".tmp";
+    int file = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file < 0) throw std::runtime_error("Failed to open snapshot file for saving.");
+
+    bool written = true;
+    size_t offset = 0;
+    while (written && offset < buffer.size()) {
+        ssize_t chunkWritten = write(file, buffer.data() + offset, std::min<size_t>(buffer.size() - offset, MAX_WRITE_CHUNK));
+        if (chunkWritten < 0 && errno == EINTR) continue;
+        written = chunkWritten > 0;
+        if (written) offset += static_cast<size_t>(chunkWritten);
+    }
+    written = written && fsync(file) == 0;
+    written = close(file) == 0 && written;
+
+    if (!written || rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        unlink(temporaryPath.c_str());
+        throw std::runtime_error("Failed to write snapshot file.");
+    }
+
+    // Makes the rename itself survive a crash
+    std::string directory = std::filesystem::path(path).parent_path().string();
+    int directoryFile = open(directory.empty() ? "." : directory.c_str(), O_RDONLY);
+    if (directoryFile >= 0) {
+        fsync(directoryFile);
+        close(directoryFile);
+    }
+}
+#endif
+
+void Snapshot::ReadFile(const std::string& path, std::vector<uint8_t>& buffer) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) throw std::runtime_error("Failed to open snapshot file for loading.");
+
+    std::streamsize size = file.tellg();
+    file.seekg(0);
+    buffer.resize(static_cast<size_t>(size));
+    if (!file.read(reinterpret_cast<char*>(buffer.data()), size)) throw std::runtime_error("Failed to read snapshot file.");
+}
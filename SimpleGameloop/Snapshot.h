@@ -0,0 +1,109 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One scene node and its sprite. Every field is a 32-bit word, so the record array is copied to
+// and from the file in one block and only needs a per-word byte swap on big-endian hosts.
+struct EntityRecord {
+    static constexpr uint32_t NO_STRING = 0xFFFFFFFFu;
+    static constexpr uint32_t COLLIDABLE = 1u;
+    static constexpr uint32_t SHAPE_SHIFT = 8;
+
+    int32_t parent;     // Index of the parent record, always an earlier one; -1 for roots
+    uint32_t handleIndex; // The entity's EntityHandle, kept across save and load
+    uint32_t handleGeneration;
+    uint32_t type;
+    uint32_t flags;     // COLLIDABLE | shape << SHAPE_SHIFT
+    float position[2];
+    float velocity[2];
+    float size[2];
+    float rotation;
+    uint32_t texture;   // String table indices or NO_STRING
+    uint32_t sound;
+    float params[2];    // Type-specific values
+};
+static_assert(sizeof(EntityRecord) == 64, "EntityRecord is written to disk as sixteen 32-bit words");
+
+// Resource paths referenced by the records; Intern stores every distinct path once
+class SnapshotStringTable {
+private:
+    static const size_t RECENT_COUNT = 4;
+
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, uint32_t> indices;
+    std::array<uint32_t, RECENT_COUNT> recentIndices = { EntityRecord::NO_STRING, EntityRecord::NO_STRING, EntityRecord::NO_STRING, EntityRecord::NO_STRING };
+    size_t nextRecent = 0;
+
+public:
+    uint32_t Intern(const std::string& value);
+    void Append(std::string value);
+    const std::string& Get(uint32_t index) const;
+    size_t Size() const { return strings.size(); }
+    const std::vector<std::string>& GetStrings() const { return strings; }
+    void Clear();
+};
+
+struct SnapshotData {
+    std::vector<EntityRecord> records; // Scene graph in pre-order
+    SnapshotStringTable strings;
+    uint32_t nextGeneration = 0; // Above every handle generation the saved GameState handed out
+
+    void Clear() {
+        records.clear();
+        strings.Clear();
+        nextGeneration = 0;
+    }
+};
+
+// Decoded snapshot that borrows its records from the buffer it was decoded from, so it must not
+// outlive that buffer. Only big-endian hosts or misaligned buffers copy the records.
+struct SnapshotView {
+    std::span<const EntityRecord> records;
+    SnapshotStringTable strings;
+    uint32_t nextGeneration = 0;
+
+private:
+    std::vector<EntityRecord> ownedRecords;
+    friend class Snapshot;
+};
+
+// Snapshot file, all little-endian:
+//   header   8 words: magic, version, header size, record count, string count, string bytes,
+//            next handle generation, checksum of everything after the header
+//   records  record count * 64 bytes
+//   strings  per string: 32-bit length, then the bytes
+class Snapshot {
+public:
+    static const uint32_t MAGIC = 0x534C4753; // "SGLS"
+    static const uint32_t VERSION = 3;
+    static const uint32_t HEADER_SIZE = 32;
+
+    static void Encode(const SnapshotData& snapshot, std::vector<uint8_t>& buffer);
+    // Checks magic, version, section sizes, checksum and record references; throws
+    // std::runtime_error without touching snapshot's records if any of them is off
+    static void Decode(const uint8_t* data, size_t size, SnapshotData& snapshot);
+    // Same checks, but the view's records point straight into data
+    static void Decode(const uint8_t* data, size_t size, SnapshotView& view);
+
+    // Deltas only exist in memory (rewind history), so they carry no header or checksum. They need
+    // the same record count and string table on both sides; anything else takes a full snapshot.
+    static bool CanEncodeDelta(const SnapshotData& base, const SnapshotData& snapshot);
+    // Per changed record: varint count of unchanged records skipped, varint mask of changed words,
+    // then each changed word XORed with the base word as a varint. Small moves only flip the low
+    // mantissa bits of a float, so most of them fit in two or three bytes.
+    static void EncodeDelta(const SnapshotData& base, const SnapshotData& snapshot, std::vector<uint8_t>& buffer);
+    // Turns the base the delta was encoded against into the snapshot it was encoded from
+    static void ApplyDelta(const uint8_t* data, size_t size, SnapshotData& snapshot);
+
+    // FNV-1a over 32-bit little-endian words, then over the trailing bytes
+    static uint32_t Checksum(const uint8_t* data, size_t size);
+
+    // Writes path + ".tmp", flushes it to disk and renames it over path, so a crash mid-save leaves
+    // the previous snapshot in place
+    static void WriteFile(const std::string& path, const std::vector<uint8_t>& buffer);
+    static void ReadFile(const std::string& path, std::vector<uint8_t>& buffer);
+};
@@ -0,0 +1,73 @@
+#include "SnapshotWriter.h"
+#include <chrono>
+#include <exception>
+
+SnapshotWriter::SnapshotWriter() : worker(&SnapshotWriter::WorkerLoop, this) {}
+
+SnapshotWriter::~SnapshotWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeWorker.notify_one();
+    worker.join();
+}
+
+bool SnapshotWriter::IsBusy() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return busy;
+}
+
+bool SnapshotWriter::Submit(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (busy) return false;
+
+        std::swap(captureBuffer, pendingSnapshot);
+        pendingPath = path;
+        busy = true;
+    }
+    wakeWorker.notify_one();
+    return true;
+}
+
+std::optional<SnapshotWriter::Result> SnapshotWriter::PollResult() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::optional<Result> result = std::move(finishedResult);
+    finishedResult.reset();
+    return result;
+}
+
+void SnapshotWriter::Wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    saveFinished.wait(lock, [this] { return !busy; });
+}
+
+// Runs the queued save even when stopping, so closing the game never drops it
+void SnapshotWriter::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeWorker.wait(lock, [this] { return busy || stopping; });
+        if (!busy) return;
+
+        std::string path = pendingPath;
+        lock.unlock();
+
+        Result result{ path, true, "", 0.0 };
+        auto start = std::chrono::steady_clock::now();
+        try {
+            Snapshot::Encode(pendingSnapshot, encoded);
+            Snapshot::WriteFile(path, encoded);
+        }
+        catch (const std::exception& e) {
+            result.succeeded = false;
+            result.error = e.what();
+        }
+        result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        lock.lock();
+        finishedResult = std::move(result);
+        busy = false;
+        saveFinished.notify_all();
+    }
+}
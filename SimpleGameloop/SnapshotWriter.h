@@ -0,0 +1,55 @@
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Snapshot.h"
+
+// Encodes and writes snapshots on a background thread. The game thread fills GetCaptureBuffer()
+// at a tick boundary and calls Submit, which swaps it with the worker's buffer instead of copying,
+// so both buffers keep their capacity between saves. Only one save is in flight at a time.
+class SnapshotWriter {
+public:
+    struct Result {
+        std::string path;
+        bool succeeded;
+        std::string error;
+        double milliseconds; // Encode and write time on the worker
+    };
+
+    SnapshotWriter();
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+    // Finishes the save in flight before returning
+    ~SnapshotWriter();
+
+    bool IsBusy() const;
+
+    // Game thread only, and only while !IsBusy()
+    SnapshotData& GetCaptureBuffer() { return captureBuffer; }
+    // Returns false without doing anything while the previous save is still running
+    bool Submit(const std::string& path);
+
+    // Hands back each finished save once, without blocking
+    std::optional<Result> PollResult();
+    // Blocks until the save in flight, if any, is on disk
+    void Wait();
+
+private:
+    SnapshotData captureBuffer;
+    SnapshotData pendingSnapshot;
+    std::vector<uint8_t> encoded;
+    std::string pendingPath;
+    std::optional<Result> finishedResult;
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeWorker;
+    std::condition_variable saveFinished;
+    bool busy = false;
+    bool stopping = false;
+    std::thread worker;
+
+    void WorkerLoop();
+};
@@ -0,0 +1,221 @@
+#pragma once
+#include "BroadPhase.h"
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Uniform grid over unbounded integer cell coordinates, hashed into a flat bucket table that is
+// rebuilt with a counting sort every tick. Nothing is allocated per cell and bodies outside the
+// world bounds are filed like any other. Bodies covering more than MAX_CELLS_PER_ENTRY cells
+// (backgrounds) are kept aside and tested against everything instead.
+class SpatialHashGrid : public BroadPhase {
+public:
+    static constexpr float TYPICAL_BODY_SIZE = 100.0f; // What SpriteFactory creates
+    static constexpr float DEFAULT_CELL_SIZE = 2.0f * TYPICAL_BODY_SIZE;
+
+private:
+    static const size_t NO_PROXY = SceneNode::NO_PROXY;
+    static const int MAX_CELLS_PER_ENTRY = 64;
+    static constexpr float MAX_CELL_COORDINATE = 1 << 30;
+
+    struct Entry {
+        float minX;
+        float maxX;
+        float minY;
+        float maxY;
+        int cellMinX;
+        int cellMinY;
+        int cellMaxX;
+        int cellMaxY;
+        bool collidable;
+        bool oversized;
+        std::shared_ptr<SceneNode> node;
+    };
+
+    struct CellItem {
+        int cellX;
+        int cellY;
+        uint32_t entry;
+    };
+
+    float cellSize;
+    std::vector<Entry> entries;
+    std::vector<uint32_t> oversized;
+    std::vector<uint32_t> bucketStarts; // bucketStarts[b]..bucketStarts[b + 1] index cellItems
+    std::vector<uint32_t> bucketCursors;
+    std::vector<CellItem> cellItems;
+    size_t bucketMask = 0;
+    bool gridBuilt = false;
+
+    int CellCoordinate(float value) const {
+        return static_cast<int>(std::clamp(std::floor(value / cellSize), -MAX_CELL_COORDINATE, MAX_CELL_COORDINATE));
+    }
+
+    // Cells in [minX, maxX] x [minY, maxY], computed wide: coordinates near the clamp overflow an int
+    static int64_t CellCount(int minX, int minY, int maxX, int maxY) {
+        return (static_cast<int64_t>(maxX) - minX + 1) * (static_cast<int64_t>(maxY) - minY + 1);
+    }
+
+    size_t Bucket(int cellX, int cellY) const {
+        return ((static_cast<uint32_t>(cellX) * 73856093u) ^ (static_cast<uint32_t>(cellY) * 19349663u)) & bucketMask;
+    }
+
+    static bool Overlaps(const Entry& a, const Entry& b) {
+        return a.minX <= b.maxX && b.minX <= a.maxX && a.minY <= b.maxY && b.minY <= a.maxY;
+    }
+
+    static bool Overlaps(const Entry& entry, const Rectangle& rect) {
+        return entry.minX <= rect.x + rect.width && rect.x <= entry.maxX && entry.minY <= rect.y + rect.height && rect.y <= entry.maxY;
+    }
+
+    void BuildGrid() {
+        oversized.clear();
+        size_t itemCount = 0;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i].oversized) oversized.push_back(static_cast<uint32_t>(i));
+            else itemCount += static_cast<size_t>(CellCount(entries[i].cellMinX, entries[i].cellMinY, entries[i].cellMaxX, entries[i].cellMaxY));
+        }
+
+        size_t bucketCount = 16;
+        while (bucketCount < itemCount * 2) bucketCount *= 2;
+        bucketMask = bucketCount - 1;
+        bucketStarts.assign(bucketCount + 1, 0);
+
+        for (const auto& entry : entries) {
+            if (entry.oversized) continue;
+            for (int y = entry.cellMinY; y <= entry.cellMaxY; ++y)
+                for (int x = entry.cellMinX; x <= entry.cellMaxX; ++x) ++bucketStarts[Bucket(x, y) + 1];
+        }
+        for (size_t b = 0; b < bucketCount; ++b) bucketStarts[b + 1] += bucketStarts[b];
+
+        bucketCursors.assign(bucketStarts.begin(), bucketStarts.end() - 1);
+        cellItems.resize(itemCount);
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const Entry& entry = entries[i];
+            if (entry.oversized) continue;
+            for (int y = entry.cellMinY; y <= entry.cellMaxY; ++y)
+                for (int x = entry.cellMinX; x <= entry.cellMaxX; ++x)
+                    cellItems[bucketCursors[Bucket(x, y)]++] = { x, y, static_cast<uint32_t>(i) };
+        }
+        gridBuilt = true;
+    }
+
+public:
+    explicit SpatialHashGrid(float cellSize = DEFAULT_CELL_SIZE) : cellSize(cellSize) {}
+
+    SpatialHashGrid(const SpatialHashGrid&) = delete;
+    SpatialHashGrid& operator=(const SpatialHashGrid&) = delete;
+
+    ~SpatialHashGrid() override {
+        Clear();
+    }
+
+    float GetCellSize() const { return cellSize; }
+
+    void Clear() override {
+        for (auto& entry : entries) entry.node->broadPhaseProxy = NO_PROXY;
+        entries.clear();
+        gridBuilt = false;
+    }
+
+    void Update(const std::shared_ptr<SceneNode>& node) override {
+        if (node->broadPhaseProxy == NO_PROXY) {
+            node->broadPhaseProxy = entries.size();
+            entries.push_back({ 0, 0, 0, 0, 0, 0, 0, 0, false, false, node });
+        }
+
+        Rectangle bounds = node->GetBounds();
+        Entry& entry = entries[node->broadPhaseProxy];
+        entry.minX = bounds.x;
+        entry.maxX = bounds.x + bounds.width;
+        entry.minY = bounds.y;
+        entry.maxY = bounds.y + bounds.height;
+        entry.cellMinX = CellCoordinate(entry.minX);
+        entry.cellMinY = CellCoordinate(entry.minY);
+        entry.cellMaxX = CellCoordinate(entry.maxX);
+        entry.cellMaxY = CellCoordinate(entry.maxY);
+        entry.collidable = node->IsCollidable();
+        entry.oversized = CellCount(entry.cellMinX, entry.cellMinY, entry.cellMaxX, entry.cellMaxY) > MAX_CELLS_PER_ENTRY;
+        gridBuilt = false;
+    }
+
+    void Remove(SceneNode& node) override {
+        if (node.broadPhaseProxy == NO_PROXY) return;
+
+        size_t index = node.broadPhaseProxy;
+        if (index != entries.size() - 1) {
+            entries[index] = std::move(entries.back());
+            entries[index].node->broadPhaseProxy = index;
+        }
+        entries.pop_back();
+        node.broadPhaseProxy = NO_PROXY;
+        gridBuilt = false;
+    }
+
+    // Two bodies share every cell their overlap covers, so a pair is only reported from the cell
+    // holding the top-left corner of the overlap; touching edges count as overlap
+    void CollectPairs(std::vector<std::pair<SceneNode*, SceneNode*>>& pairs) override {
+        BuildGrid();
+
+        for (size_t b = 0; b + 1 < bucketStarts.size(); ++b) {
+            for (uint32_t i = bucketStarts[b]; i < bucketStarts[b + 1]; ++i) {
+                const CellItem& item = cellItems[i];
+                const Entry& entry = entries[item.entry];
+                if (!entry.collidable) continue;
+
+                for (uint32_t j = i + 1; j < bucketStarts[b + 1]; ++j) {
+                    const CellItem& otherItem = cellItems[j];
+                    if (otherItem.cellX != item.cellX || otherItem.cellY != item.cellY) continue;
+
+                    const Entry& other = entries[otherItem.entry];
+                    if (!other.collidable || !Overlaps(entry, other)) continue;
+                    if (std::max(entry.cellMinX, other.cellMinX) != item.cellX || std::max(entry.cellMinY, other.cellMinY) != item.cellY) continue;
+
+                    pairs.emplace_back(entry.node.get(), other.node.get());
+                }
+            }
+        }
+
+        for (size_t i = 0; i < oversized.size(); ++i) {
+            const Entry& entry = entries[oversized[i]];
+            if (!entry.collidable) continue;
+
+            for (size_t j = 0; j < entries.size(); ++j) {
+                const Entry& other = entries[j];
+                if (j == oversized[i] || !other.collidable || (other.oversized && j < oversized[i])) continue;
+                if (Overlaps(entry, other)) pairs.emplace_back(entry.node.get(), other.node.get());
+            }
+        }
+    }
+
+    void Retrieve(const Rectangle& rect, std::vector<SceneNode*>& result) const override {
+        int minX = CellCoordinate(rect.x);
+        int minY = CellCoordinate(rect.y);
+        int maxX = CellCoordinate(rect.x + rect.width);
+        int maxY = CellCoordinate(rect.y + rect.height);
+
+        if (!gridBuilt || CellCount(minX, minY, maxX, maxY) > static_cast<int64_t>(entries.size())) {
+            for (const auto& entry : entries)
+                if (Overlaps(entry, rect)) result.push_back(entry.node.get());
+            return;
+        }
+
+        for (int y = minY; y <= maxY; ++y) {
+            for (int x = minX; x <= maxX; ++x) {
+                size_t b = Bucket(x, y);
+                for (uint32_t i = bucketStarts[b]; i < bucketStarts[b + 1]; ++i) {
+                    const CellItem& item = cellItems[i];
+                    if (item.cellX != x || item.cellY != y) continue;
+
+                    const Entry& entry = entries[item.entry];
+                    if (std::max(entry.cellMinX, minX) == x && std::max(entry.cellMinY, minY) == y && Overlaps(entry, rect))
+                        result.push_back(entry.node.get());
+                }
+            }
+        }
+        for (uint32_t index : oversized)
+            if (Overlaps(entries[index], rect)) result.push_back(entries[index].node.get());
+    }
+};
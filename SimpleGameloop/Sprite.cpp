@@ -1,34 +1,47 @@
 #include "Sprite.h"
+#include <stdexcept>
 
-Sprite::Sprite(Vector2 initialPosition, Vector2 size, float initialRotation, Vector2 initialVelocity, ShapeType shape, bool collidable)
-    : position(initialPosition), rotation(initialRotation), velocity(initialVelocity), collidable(collidable), shape(shape), size(size) {}
+Sprite::Sprite(SpriteType type, Vector2 initialPosition, Vector2 size, float initialRotation, Vector2 initialVelocity, ShapeType shape, bool collidable)
+    : store(&EntityStore::CreationTarget()),
+    slot(store->Allocate(this, initialPosition, size, initialRotation, initialVelocity, shape, collidable)), type(type) {}
 
-void Sprite::Update(float deltaTime, int screenWidth, int screenHeight) {
+Sprite::~Sprite() {
+    Store().Release(slot);
+}
+
+void Sprite::Update(float deltaTime, int screenWidth, int screenHeight, const InputState& input) {
     // Default Update: Do nothing
 }
 void Sprite::OnCollision() const {
     // Default Reaction: Absent
 }
 
-void Sprite::Draw(int global_x, int global_y) const {
+void Sprite::QueueDraw(RenderQueue& queue, uint32_t order, Vector2 position, float rotation) const {
     // Default Draw: Represent a blank sprite
 }
 
-void Sprite::Save(std::ofstream& file) const {
-    file.write((char*)&position, sizeof(position));
-    file.write((char*)&rotation, sizeof(rotation));
-    file.write((char*)&velocity, sizeof(velocity));
-    file.write((char*)&size, sizeof(size));
-    file.write((char*)&shape, sizeof(shape));
-    file.write((char*)&collidable, sizeof(collidable));
+void Sprite::Save(EntityRecord& record, SnapshotStringTable& strings) const {
+    record.flags = (IsCollidable() ? EntityRecord::COLLIDABLE : 0u) | (static_cast<uint32_t>(Shape()) << EntityRecord::SHAPE_SHIFT);
+    record.position[0] = Position().x;
+    record.position[1] = Position().y;
+    record.velocity[0] = Velocity().x;
+    record.velocity[1] = Velocity().y;
+    record.size[0] = Size().x;
+    record.size[1] = Size().y;
+    record.rotation = Rotation();
+    record.texture = EntityRecord::NO_STRING;
+    record.sound = EntityRecord::NO_STRING;
+    record.params[0] = record.params[1] = 0.0f;
 }
 
-void Sprite::Load(std::ifstream& file) {
-    file.read((char*)&position, sizeof(position));
-    file.read((char*)&rotation, sizeof(rotation));
-    file.read((char*)&velocity, sizeof(velocity));
-    file.read((char*)&size, sizeof(size));
-    file.read((char*)&shape, sizeof(shape));
-    file.read((char*)&collidable, sizeof(collidable));
-}
+void Sprite::Load(const EntityRecord& record, const SnapshotStringTable& strings) {
+    uint32_t shape = record.flags >> EntityRecord::SHAPE_SHIFT;
+    if (shape > Rectangular) throw std::runtime_error("Unknown shape in snapshot");
 
+    Position() = { record.position[0], record.position[1] };
+    Velocity() = { record.velocity[0], record.velocity[1] };
+    Size() = { record.size[0], record.size[1] };
+    Rotation() = record.rotation;
+    Shape() = static_cast<ShapeType>(shape);
+    SetCollidable((record.flags & EntityRecord::COLLIDABLE) != 0);
+}
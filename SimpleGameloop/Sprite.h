@@ -1,24 +1,52 @@
 #pragma once
 #include "Saveable.h"
 #include "raylib.h"
-#include <fstream>
 #include "ShapeType.h"
+#include "EntityStore.h"
+#include "InputState.h"
+#include "SpriteType.h"
+#include "RenderQueue.h"
 
+// Transform and physics state live in an EntityStore; a Sprite is a view over its slot
 class Sprite : public Saveable {
+private:
+    friend class EntityStore;
+    EntityStore* store;
+    size_t slot;
+    SpriteType type;
+
+    EntityStore& Store() const { return *store; }
+
 public:
-    Vector2 velocity;
-    bool collidable;
-    Vector2 position;
-    Vector2 size;
-    float rotation;
-    ShapeType shape;
+    Sprite(SpriteType type, Vector2 initialPosition = { 0, 0 }, Vector2 size = { 0, 0 }, float initialRotation = 0.0f, Vector2 initialVelocity = { 0, 0 }, ShapeType shape = Circular, bool collidable = true);
+    Sprite(const Sprite&) = delete;
+    Sprite& operator=(const Sprite&) = delete;
+    ~Sprite() override;
+
+    size_t GetSlot() const { return slot; }
+    EntityStore& GetStore() const { return *store; }
+    SpriteType GetType() const { return type; }
 
-    Sprite(Vector2 initialPosition = { 0, 0 }, Vector2 size = { 0, 0 }, float initialRotation = 0.0f, Vector2 initialVelocity = { 0, 0 }, ShapeType shape = Circular, bool collidable = true);
+    Vector2& Position() { return Store().positions[slot]; }
+    const Vector2& Position() const { return Store().positions[slot]; }
+    Vector2& Velocity() { return Store().velocities[slot]; }
+    const Vector2& Velocity() const { return Store().velocities[slot]; }
+    Vector2& Size() { return Store().sizes[slot]; }
+    const Vector2& Size() const { return Store().sizes[slot]; }
+    float& Rotation() { return Store().rotations[slot]; }
+    float Rotation() const { return Store().rotations[slot]; }
+    ShapeType& Shape() { return Store().shapes[slot]; }
+    ShapeType Shape() const { return Store().shapes[slot]; }
+    bool IsCollidable() const { return Store().collidable[slot] != 0; }
+    void SetCollidable(bool collidable) { Store().collidable[slot] = collidable; }
 
-    virtual void Update(float deltaTime, int screenWidth, int screenHeight);
+    virtual void Update(float deltaTime, int screenWidth, int screenHeight, const InputState& input);
     virtual void OnCollision() const;
-    virtual void Draw(int global_x, int global_y) const;
+    // Adds this sprite's quads at global position; order goes into DrawCommand::order
+    virtual void QueueDraw(RenderQueue& queue, uint32_t order, Vector2 position, float rotation) const;
+    // Drawn whether or not its bounds touch the viewport, like a background tiling the whole screen
+    virtual bool IsAlwaysVisible() const { return false; }
 
-    void Save(std::ofstream& file) const override;
-    void Load(std::ifstream& file) override;
+    void Save(EntityRecord& record, SnapshotStringTable& strings) const override;
+    void Load(const EntityRecord& record, const SnapshotStringTable& strings) override;
 };
@@ -1,59 +1,95 @@
+#pragma once
 #include <vector>
 #include <memory>
+#include <random>
 #include "SceneNode.h"
+#include "ObjectPool.h"
 #include "ResourceManager.h"
-#include "Player.h"
-#include "Background.h"
+#include "SpriteType.h"
+#include "SpriteRegistry.h"
 #include <cmath>
-#include "Wall.h"
-#include "Platform.h"
+
+enum class SpawnLayout {
+    Line,   // Evenly spaced along the diagonal of bounds; a zero height makes it a horizontal row
+    Grid,   // Rows and columns of near-square cells filling bounds, one sprite in the middle of each
+    Random  // Uniformly scattered over bounds
+};
+
+struct SpawnDescriptor {
+    SpriteType type = SpriteType::PlayerSprite;
+    int count = 1;
+    SpawnLayout layout = SpawnLayout::Line;
+    Rectangle bounds = { 0, 0, 0, 0 };
+    Vector2 size = { 100, 100 };
+    // Each axis is drawn uniformly from [min, max]. Platforms keep it as the velocity they patrol at.
+    Vector2 minVelocity = { 0, 0 };
+    Vector2 maxVelocity = { 0, 0 };
+    unsigned int seed = 0; // For Random layouts and velocity ranges
+};
 
 class SpriteFactory {
-public:
-    static std::vector<std::shared_ptr<SceneNode>> CreateSprites(
-        const std::string& spriteType,
-        int quantity,
-        const Rectangle& boundaries,
-        ResourceManager& resourceManager)
-    {
-        std::vector<std::shared_ptr<SceneNode>> sprites;
-
-        float spacingX = static_cast<float>(boundaries.width) / (quantity + 1);
-        float spacingY = static_cast<float>(boundaries.height) / (quantity + 1);
-
-        for (int i = 0; i < quantity; ++i) {
-            Vector2 position = {
-                boundaries.x + (i + 1) * spacingX,
-                boundaries.y + (i + 1) * spacingY
-            };
-
-            std::shared_ptr<SceneNode> spriteNode;
-
-            if (spriteType == "Player") {
-                spriteNode = std::make_shared<SceneNode>(
-                    std::make_shared<Player>(resourceManager, position, Vector2{ 100, 100 }, ShapeType::Circular),
-                    resourceManager
-                );
-            } else if (spriteType == "Background") {
-                spriteNode = std::make_shared<SceneNode>(
-                    std::make_shared<Background>(resourceManager),
-                    resourceManager
-                );
-            } else if (spriteType == "Wall") {
-                spriteNode = std::make_shared<SceneNode>(
-                    std::make_shared<Wall>(resourceManager, position, Vector2{ 100, 100 }, ShapeType::Rectangular),
-                    resourceManager
-                );
-            } else if (spriteType == "Platform") {
-                spriteNode = std::make_shared<SceneNode>(
-                    std::make_shared<Platform>(resourceManager, position, Vector2{ 100, 100 }, Vector2{ 100, 0 }, ShapeType::Rectangular),
-                    resourceManager
-                );
+private:
+    // One pass over the batch: a position and velocity per sprite, and createSprite turns them into one
+    template <typename CreateSprite>
+    static void SpawnEach(const SpawnDescriptor& descriptor, ResourceManager& resourceManager,
+        std::vector<std::shared_ptr<SceneNode>>& nodes, CreateSprite createSprite) {
+        const Rectangle& bounds = descriptor.bounds;
+        std::mt19937 rng(descriptor.seed);
+        std::uniform_real_distribution<float> randomX(bounds.x, bounds.x + bounds.width);
+        std::uniform_real_distribution<float> randomY(bounds.y, bounds.y + bounds.height);
+        std::uniform_real_distribution<float> velocityX(std::min(descriptor.minVelocity.x, descriptor.maxVelocity.x),
+            std::max(descriptor.minVelocity.x, descriptor.maxVelocity.x));
+        std::uniform_real_distribution<float> velocityY(std::min(descriptor.minVelocity.y, descriptor.maxVelocity.y),
+            std::max(descriptor.minVelocity.y, descriptor.maxVelocity.y));
+        bool fixedVelocity = descriptor.minVelocity.x == descriptor.maxVelocity.x && descriptor.minVelocity.y == descriptor.maxVelocity.y;
+
+        float spacingX = bounds.width / (descriptor.count + 1);
+        float spacingY = bounds.height / (descriptor.count + 1);
+
+        int columns = descriptor.count;
+        if (bounds.height > 0) columns = static_cast<int>(std::ceil(std::sqrt(descriptor.count * bounds.width / bounds.height)));
+        columns = std::clamp(columns, 1, descriptor.count);
+        int rows = (descriptor.count + columns - 1) / columns;
+        float cellWidth = bounds.width / columns;
+        float cellHeight = bounds.height / rows;
+
+        for (int i = 0; i < descriptor.count; ++i) {
+            Vector2 position;
+            switch (descriptor.layout) {
+            case SpawnLayout::Grid:
+                position = { bounds.x + (i % columns + 0.5f) * cellWidth, bounds.y + (i / columns + 0.5f) * cellHeight };
+                break;
+            case SpawnLayout::Random:
+                position = { randomX(rng), randomY(rng) };
+                break;
+            case SpawnLayout::Line:
+            default:
+                position = { bounds.x + (i + 1) * spacingX, bounds.y + (i + 1) * spacingY };
+                break;
             }
 
-            sprites.push_back(std::move(spriteNode));
+            Vector2 velocity = descriptor.minVelocity;
+            if (!fixedVelocity) velocity = { velocityX(rng), velocityY(rng) };
+
+            nodes.push_back(ObjectPool::MakeShared<SceneNode>(createSprite(position, velocity), resourceManager));
         }
+    }
+
+public:
+    // Appends descriptor.count new nodes to nodes, with their sprites in store. The texture and sound
+    // are looked up once for the whole batch, and store grows once up front.
+    static void Spawn(const SpawnDescriptor& descriptor, ResourceManager& resourceManager, EntityStore& store,
+        std::vector<std::shared_ptr<SceneNode>>& nodes) {
+        if (descriptor.count <= 0) return;
+
+        store.Reserve(store.Size() + descriptor.count);
+        EntityStore::CreationScope scope(store);
+        nodes.reserve(nodes.size() + descriptor.count);
 
-        return sprites;
+        const SpriteTypeInfo& info = SpriteRegistry::Get(descriptor.type);
+        SpriteAssets assets = info.getDefaultAssets(resourceManager, descriptor.size);
+        SpawnEach(descriptor, resourceManager, nodes, [&](Vector2 position, Vector2 velocity) {
+            return info.create(resourceManager, position, descriptor.size, velocity, assets);
+        });
     }
 };
@@ -0,0 +1,63 @@
+#pragma once
+#include <array>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include "Sprite.h"
+#include "SpriteType.h"
+#include "ResourceManager.h"
+#include "ObjectPool.h"
+#include "Player.h"
+#include "Wall.h"
+#include "Background.h"
+#include "Platform.h"
+
+// What the factory and the snapshot code need to know about one sprite type
+struct SpriteTypeInfo {
+    const char* name;
+    SpriteAssets (*getDefaultAssets)(ResourceManager& resourceManager, Vector2 size);
+    // Backgrounds ignore position, size and velocity; platforms patrol at velocity
+    std::shared_ptr<Sprite> (*create)(ResourceManager& resourceManager, Vector2 position, Vector2 size, Vector2 velocity, const SpriteAssets& assets);
+    const PoolStats& (*getPoolStats)();
+};
+
+// Builds the table for SpriteRegistry, each type at the index of its SpriteType value
+template <typename... Types>
+struct SpriteTypeList {
+    static constexpr std::array<SpriteTypeInfo, sizeof...(Types)> MakeTable() {
+        std::array<SpriteTypeInfo, sizeof...(Types)> table = {};
+        ((table[static_cast<size_t>(Types::TYPE)] = { Types::TYPE_NAME, &Types::GetDefaultAssets, &Types::Create, &ObjectPool::GetStats<Types> }), ...);
+        return table;
+    }
+
+    static constexpr bool IsComplete(const std::array<SpriteTypeInfo, sizeof...(Types)>& table) {
+        for (const SpriteTypeInfo& info : table)
+            if (!info.name) return false;
+        return true;
+    }
+};
+
+// One entry per SpriteType, indexed by its value. A new sprite type needs a SpriteType value, the
+// TYPE, TYPE_NAME, GetDefaultAssets and Create members, and a place in this list.
+using RegisteredSpriteTypes = SpriteTypeList<Player, Wall, Background, Platform>;
+
+class SpriteRegistry {
+private:
+    static constexpr auto TABLE = RegisteredSpriteTypes::MakeTable();
+    static_assert(RegisteredSpriteTypes::IsComplete(TABLE), "SpriteType values must run from 0 without gaps, one registered type each");
+
+public:
+    static const SpriteTypeInfo& Get(SpriteType type) {
+        return TABLE[static_cast<size_t>(type)];
+    }
+
+    // For type values read from a file; throws on ones no registered type has
+    static const SpriteTypeInfo& Get(uint32_t type) {
+        if (type >= TABLE.size()) throw std::runtime_error("Unknown sprite type");
+        return TABLE[type];
+    }
+
+    static std::span<const SpriteTypeInfo> GetAll() {
+        return TABLE;
+    }
+};
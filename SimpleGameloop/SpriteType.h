@@ -0,0 +1,10 @@
+#pragma once
+#include <cstdint>
+
+// Stored in EntityRecord::type, so existing values must not change
+enum class SpriteType : uint32_t {
+    PlayerSprite = 0,
+    WallSprite = 1,
+    BackgroundSprite = 2,
+    PlatformSprite = 3
+};
@@ -0,0 +1,128 @@
+#pragma once
+#include "BroadPhase.h"
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+// Sort-and-sweep on the x axis. Entries stay sorted by their left edge between ticks, so after
+// bodies move a little the insertion sort in CollectPairs only does a handful of swaps. Unlike
+// the quadtree it does not degrade when many bodies straddle the same midpoint.
+class SweepAndPrune : public BroadPhase {
+private:
+    static const size_t NO_PROXY = SceneNode::NO_PROXY;
+    static const size_t FULL_SORT_DIVISOR = 16;
+
+    struct Entry {
+        float minX;
+        float maxX;
+        float minY;
+        float maxY;
+        bool collidable;
+        std::shared_ptr<SceneNode> node;
+    };
+
+    std::vector<Entry> entries; // Sorted by minX after SortEntries
+    bool sorted = true;
+
+    // Insertion sort is linear on nearly sorted input but quadratic on a fresh or shuffled one
+    // (initial fill, load, teleports), so fall back to a full sort when many neighbours are out of order
+    void SortEntries() {
+        size_t descents = 0;
+        for (size_t i = 1; i < entries.size(); ++i)
+            if (entries[i - 1].minX > entries[i].minX) ++descents;
+
+        if (descents > entries.size() / FULL_SORT_DIVISOR) {
+            std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.minX < b.minX; });
+            for (size_t i = 0; i < entries.size(); ++i) entries[i].node->broadPhaseProxy = i;
+            sorted = true;
+            return;
+        }
+
+        for (size_t i = 1; i < entries.size(); ++i) {
+            if (entries[i - 1].minX <= entries[i].minX) continue;
+
+            Entry moving = std::move(entries[i]);
+            size_t j = i;
+            for (; j > 0 && entries[j - 1].minX > moving.minX; --j) {
+                entries[j] = std::move(entries[j - 1]);
+                entries[j].node->broadPhaseProxy = j;
+            }
+            entries[j] = std::move(moving);
+            entries[j].node->broadPhaseProxy = j;
+        }
+        sorted = true;
+    }
+
+public:
+    SweepAndPrune() = default;
+
+    SweepAndPrune(const SweepAndPrune&) = delete;
+    SweepAndPrune& operator=(const SweepAndPrune&) = delete;
+
+    ~SweepAndPrune() {
+        Clear();
+    }
+
+    void Clear() override {
+        for (auto& entry : entries) entry.node->broadPhaseProxy = NO_PROXY;
+        entries.clear();
+        sorted = true;
+    }
+
+    void Update(const std::shared_ptr<SceneNode>& node) override {
+        if (node->broadPhaseProxy == NO_PROXY) {
+            node->broadPhaseProxy = entries.size();
+            entries.push_back({ 0, 0, 0, 0, false, node });
+        }
+
+        Rectangle bounds = node->GetBounds();
+        Entry& entry = entries[node->broadPhaseProxy];
+        entry.minX = bounds.x;
+        entry.maxX = bounds.x + bounds.width;
+        entry.minY = bounds.y;
+        entry.maxY = bounds.y + bounds.height;
+        entry.collidable = node->IsCollidable();
+        sorted = false;
+    }
+
+    void Remove(SceneNode& node) override {
+        if (node.broadPhaseProxy == NO_PROXY) return;
+
+        // The last entry fills the hole; CollectPairs sorts again before it sweeps
+        size_t proxy = node.broadPhaseProxy;
+        if (proxy != entries.size() - 1) {
+            entries[proxy] = std::move(entries.back());
+            entries[proxy].node->broadPhaseProxy = proxy;
+            sorted = false;
+        }
+        entries.pop_back();
+        node.broadPhaseProxy = NO_PROXY;
+    }
+
+    // Touching edges count as overlap, matching raylib's circle tests
+    void CollectPairs(std::vector<std::pair<SceneNode*, SceneNode*>>& pairs) override {
+        SortEntries();
+
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const Entry& entry = entries[i];
+            if (!entry.collidable) continue;
+
+            for (size_t j = i + 1; j < entries.size() && entries[j].minX <= entry.maxX; ++j) {
+                const Entry& other = entries[j];
+                if (other.collidable && other.minY <= entry.maxY && entry.minY <= other.maxY)
+                    pairs.emplace_back(entry.node.get(), other.node.get());
+            }
+        }
+    }
+
+    void Retrieve(const Rectangle& rect, std::vector<SceneNode*>& result) const override {
+        float right = rect.x + rect.width;
+        float bottom = rect.y + rect.height;
+
+        for (const auto& entry : entries) {
+            if (sorted && entry.minX > right) break;
+            if (entry.maxX >= rect.x && entry.minX <= right && entry.maxY >= rect.y && entry.minY <= bottom)
+                result.push_back(entry.node.get());
+        }
+    }
+};
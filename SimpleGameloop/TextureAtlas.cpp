@@ -0,0 +1,208 @@
+#include "TextureAtlas.h"
+#include <algorithm>
+#include <stdexcept>
+
+AtlasPacker::AtlasPacker(int width, int height, int padding) : width(width), height(height), padding(padding) {
+    Clear();
+}
+
+void AtlasPacker::Clear() {
+    skyline.assign(1, { 0, 0, width });
+    freeRectangles.clear();
+    usedArea = 0;
+}
+
+int AtlasPacker::FitAt(size_t index, int width, int height) const {
+    int x = skyline[index].x;
+    if (x + width > this->width) return -1;
+
+    int y = 0;
+    for (int widthLeft = width; widthLeft > 0; widthLeft -= skyline[index].width, ++index) {
+        y = std::max(y, skyline[index].y);
+        if (y + height > this->height) return -1;
+    }
+    return y;
+}
+
+// Best area fit among the freed rectangles; the unused right and bottom strips are freed again
+bool AtlasPacker::InsertIntoFreed(int paddedWidth, int paddedHeight, Rectangle& placement) {
+    size_t best = freeRectangles.size();
+    float bestArea = 0.0f;
+    for (size_t i = 0; i < freeRectangles.size(); ++i) {
+        const Rectangle& candidate = freeRectangles[i];
+        if (candidate.width < paddedWidth || candidate.height < paddedHeight) continue;
+        float area = candidate.width * candidate.height;
+        if (best == freeRectangles.size() || area < bestArea) {
+            best = i;
+            bestArea = area;
+        }
+    }
+    if (best == freeRectangles.size()) return false;
+
+    Rectangle chosen = freeRectangles[best];
+    freeRectangles[best] = freeRectangles.back();
+    freeRectangles.pop_back();
+
+    if (chosen.width > paddedWidth)
+        freeRectangles.push_back({ chosen.x + paddedWidth, chosen.y, chosen.width - paddedWidth, static_cast<float>(paddedHeight) });
+    if (chosen.height > paddedHeight)
+        freeRectangles.push_back({ chosen.x, chosen.y + paddedHeight, chosen.width, chosen.height - paddedHeight });
+
+    placement.x = chosen.x;
+    placement.y = chosen.y;
+    return true;
+}
+
+bool AtlasPacker::Insert(int width, int height, Rectangle& placement) {
+    if (width <= 0 || height <= 0) return false;
+    int paddedWidth = std::min(width + padding, this->width);
+    int paddedHeight = std::min(height + padding, this->height);
+    if (width > this->width || height > this->height) return false;
+
+    if (InsertIntoFreed(paddedWidth, paddedHeight, placement)) {
+        placement.width = static_cast<float>(width);
+        placement.height = static_cast<float>(height);
+        usedArea += static_cast<int64_t>(width) * height;
+        return true;
+    }
+
+    // Lowest top edge wins, then the narrowest segment, which leaves wider gaps for later rectangles
+    size_t bestIndex = skyline.size();
+    int bestY = 0;
+    int bestTop = this->height + 1;
+    int bestWidth = 0;
+    for (size_t i = 0; i < skyline.size(); ++i) {
+        int y = FitAt(i, paddedWidth, paddedHeight);
+        if (y < 0) continue;
+        int top = y + paddedHeight;
+        if (top < bestTop || (top == bestTop && skyline[i].width < bestWidth)) {
+            bestIndex = i;
+            bestY = y;
+            bestTop = top;
+            bestWidth = skyline[i].width;
+        }
+    }
+    if (bestIndex == skyline.size()) return false;
+
+    int x = skyline[bestIndex].x;
+    skyline.insert(skyline.begin() + bestIndex, { x, bestTop, paddedWidth });
+
+    // Trim or drop the segments the new one now covers
+    int right = x + paddedWidth;
+    size_t next = bestIndex + 1;
+    while (next < skyline.size() && skyline[next].x < right) {
+        int overlap = right - skyline[next].x;
+        if (overlap < skyline[next].width) {
+            skyline[next].x += overlap;
+            skyline[next].width -= overlap;
+            break;
+        }
+        skyline.erase(skyline.begin() + next);
+    }
+
+    for (size_t i = 0; i + 1 < skyline.size();) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else ++i;
+    }
+
+    usedArea += static_cast<int64_t>(width) * height;
+    placement = { static_cast<float>(x), static_cast<float>(bestY), static_cast<float>(width), static_cast<float>(height) };
+    return true;
+}
+
+void AtlasPacker::Free(const Rectangle& placement) {
+    usedArea -= static_cast<int64_t>(placement.width) * static_cast<int64_t>(placement.height);
+    if (usedArea <= 0) {
+        Clear();
+        return;
+    }
+
+    float paddedWidth = std::min(placement.width + padding, width - placement.x);
+    float paddedHeight = std::min(placement.height + padding, height - placement.y);
+    freeRectangles.push_back({ placement.x, placement.y, paddedWidth, paddedHeight });
+}
+
+float AtlasPacker::GetOccupancy() const {
+    return static_cast<float>(static_cast<double>(usedArea) / (static_cast<double>(width) * height));
+}
+
+TextureAtlas::TextureAtlas(bool uploadToGpu) : uploadToGpu(uploadToGpu) {}
+
+TextureAtlas::~TextureAtlas() {
+    Clear();
+}
+
+AtlasRegion TextureAtlas::Place(int width, int height) {
+    if (width <= 0 || height <= 0) throw std::runtime_error("Atlas images must not be empty");
+
+    AtlasRegion region;
+    for (uint32_t page = 0; page < pages.size(); ++page) {
+        if (pages[page].packer.Insert(width, height, region.source)) {
+            region.page = page;
+            return region;
+        }
+    }
+
+    int pageWidth = std::max(PAGE_SIZE, width);
+    int pageHeight = std::max(PAGE_SIZE, height);
+    pages.push_back({ AtlasPacker(pageWidth, pageHeight, PADDING) });
+    pages.back().packer.Insert(width, height, region.source);
+    region.page = static_cast<uint32_t>(pages.size() - 1);
+    return region;
+}
+
+AtlasRegion TextureAtlas::Allocate(int width, int height) {
+    AtlasRegion region = Place(width, height);
+    Page& page = pages[region.page];
+    region.texture = { page.texture.id, page.packer.GetWidth(), page.packer.GetHeight(), 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+    return region;
+}
+
+AtlasRegion TextureAtlas::Add(const Image& image) {
+    AtlasRegion region = Place(image.width, image.height);
+    Page& page = pages[region.page];
+
+    Image pixels = ImageCopy(image);
+    ImageFormat(&pixels, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    if (!page.image.data) page.image = GenImageColor(page.packer.GetWidth(), page.packer.GetHeight(), BLANK);
+    ImageDraw(&page.image, pixels, { 0, 0, region.source.width, region.source.height }, region.source, WHITE);
+
+    // The page texture keeps its id as regions are added, so regions handed out earlier stay valid
+    if (uploadToGpu) {
+        if (page.texture.id == 0) page.texture = LoadTextureFromImage(page.image);
+        else UpdateTextureRec(page.texture, region.source, pixels.data);
+    }
+    UnloadImage(pixels);
+
+    region.texture = page.texture;
+    if (!uploadToGpu) region.texture = { 0, page.image.width, page.image.height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+    return region;
+}
+
+void TextureAtlas::Free(const AtlasRegion& region) {
+    Page& page = pages[region.page];
+    page.packer.Free(region.source);
+    if (page.packer.IsEmpty()) ReleasePage(page);
+}
+
+void TextureAtlas::ReleasePage(Page& page) {
+    if (page.texture.id != 0) UnloadTexture(page.texture);
+    if (page.image.data) UnloadImage(page.image);
+    page.texture = {};
+    page.image = {};
+}
+
+void TextureAtlas::Clear() {
+    for (Page& page : pages) ReleasePage(page);
+    pages.clear();
+}
+
+size_t TextureAtlas::GetResidentBytes() const {
+    size_t bytes = 0;
+    for (const Page& page : pages)
+        if (!page.packer.IsEmpty()) bytes += static_cast<size_t>(page.packer.GetWidth()) * page.packer.GetHeight() * 4;
+    return bytes;
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include "raylib.h"
+#include <vector>
+#include <cstdint>
+
+// Skyline bottom-left rectangle packer. Only tracks free space, so it runs without a GPU or any
+// pixels; TextureAtlas pairs it with the images that go into the rectangles. Freed rectangles are
+// kept in a list and handed out again, split guillotine-style, before the skyline grows.
+class AtlasPacker {
+private:
+    // The top edge of the used area over [x, x + width)
+    struct SkylineSegment {
+        int x;
+        int y;
+        int width;
+    };
+
+    int width;
+    int height;
+    int padding; // Kept free right of and below each rectangle, so neighbours do not bleed into each other
+    std::vector<SkylineSegment> skyline;
+    std::vector<Rectangle> freeRectangles; // Padded, so neighbours keep their gap
+    int64_t usedArea = 0;
+
+    // Lowest y a width x height rectangle can sit at with its left edge on segment index, or -1
+    int FitAt(size_t index, int width, int height) const;
+    bool InsertIntoFreed(int paddedWidth, int paddedHeight, Rectangle& placement);
+
+public:
+    AtlasPacker(int width, int height, int padding = 0);
+
+    // False, leaving the packer unchanged, when there is no room
+    bool Insert(int width, int height, Rectangle& placement);
+    // placement must have come from Insert. Freeing the last rectangle clears the packer.
+    void Free(const Rectangle& placement);
+    void Clear();
+    bool IsEmpty() const { return usedArea == 0; }
+
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    // Share of the area covered by inserted rectangles, padding excluded
+    float GetOccupancy() const;
+};
+
+// Where a texture ended up: a page texture and the pixel rectangle on it, as DrawTexturePro takes them
+struct AtlasRegion {
+    uint32_t page = 0;
+    Texture2D texture = {};
+    Rectangle source = { 0, 0, 0, 0 };
+};
+
+// Packs images into shared page textures, so sprites with different images can be batched by raylib
+// without switching textures. An image too big for a page gets a page of its own. A page whose
+// regions have all been freed lets go of its pixels and texture, and is filled again later.
+class TextureAtlas {
+public:
+    static constexpr int PAGE_SIZE = 2048;
+    static constexpr int PADDING = 2;
+
+private:
+    struct Page {
+        AtlasPacker packer;
+        Image image = {};      // CPU copy, created on the first Add after the page was empty
+        Texture2D texture = {}; // Created along with image when uploading
+    };
+
+    std::vector<Page> pages;
+    bool uploadToGpu;
+
+    AtlasRegion Place(int width, int height);
+    void ReleasePage(Page& page);
+
+public:
+    // Without uploadToGpu nothing touches the graphics context, so packing can run headless
+    TextureAtlas(bool uploadToGpu = true);
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+    ~TextureAtlas();
+
+    // Copies image into a page; the caller keeps ownership of image
+    AtlasRegion Add(const Image& image);
+    // Reserves space without pixels, for headless sprites that only need sizes
+    AtlasRegion Allocate(int width, int height);
+    // Gives region's rectangle back to its page; the region must not be drawn afterwards
+    void Free(const AtlasRegion& region);
+    void Clear();
+
+    size_t GetPageCount() const { return pages.size(); }
+    // Pixel memory of every page holding at least one region, at 4 bytes a pixel. Headless pages
+    // keep no pixels but are counted as if they did.
+    size_t GetResidentBytes() const;
+    const Image& GetPageImage(uint32_t page) const { return pages[page].image; }
+    float GetOccupancy(uint32_t page) const { return pages[page].packer.GetOccupancy(); }
+};
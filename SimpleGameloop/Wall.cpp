@@ -1,4 +1,5 @@
 #include "Wall.h"
+#include "ObjectPool.h"
 
 Wall::Wall(
     ResourceManager& resourceManager,
@@ -8,38 +9,65 @@ Wall::Wall(
     const std::string& texturePath,
     const std::string& bounceSoundPath,
     bool collidable
-) : Sprite(initialPosition, size, 0.0, { 0, 0 }, shape, collidable),
-texturePath(texturePath),
-bounceSoundPath(bounceSoundPath),
-resourceManager(resourceManager)
-{
-    texture = resourceManager.GetTexture(texturePath, size.x, size.y);
-    bounceSound = resourceManager.GetSound(bounceSoundPath);
+) : Wall(resourceManager, initialPosition, size, resourceManager.GetSpriteAssets(texturePath, bounceSoundPath, size.x, size.y), shape, collidable) {}
+
+Wall::Wall(
+    ResourceManager& resourceManager,
+    Vector2 initialPosition,
+    Vector2 size,
+    SpriteAssets assets,
+    ShapeType shape,
+    bool collidable
+) : Sprite(TYPE, initialPosition, size, 0.0, { 0, 0 }, shape, collidable),
+texture(assets.texture),
+bounceSound(assets.sound),
+resourceManager(resourceManager) {
+    resourceManager.Retain(texture);
+    resourceManager.Retain(bounceSound);
 }
 
-void Wall::OnCollision() const {
-    PlaySound(bounceSound);
+Wall::~Wall() {
+    resourceManager.Release(texture);
+    resourceManager.Release(bounceSound);
 }
 
-void Wall::Draw(int global_x, int global_y) const {
-    Rectangle source = { 0, 0, (float)texture.width, (float)texture.height };
-    Rectangle destination = { global_x, global_y, size.x, size.y };
-    Vector2 origin = { size.x / 2.0f, size.y / 2.0f };
+SpriteAssets Wall::GetDefaultAssets(ResourceManager& resourceManager, Vector2 size) {
+    return resourceManager.GetSpriteAssets(DEFAULT_TEXTURE, DEFAULT_SOUND, size.x, size.y);
+}
 
-    DrawTexturePro(texture, source, destination, origin, rotation, WHITE);
+std::shared_ptr<Sprite> Wall::Create(ResourceManager& resourceManager, Vector2 position, Vector2 size, Vector2 velocity, const SpriteAssets& assets) {
+    auto wall = ObjectPool::MakeShared<Wall>(resourceManager, position, size, assets);
+    wall->Velocity() = velocity;
+    return wall;
 }
 
-void Wall::Save(std::ofstream& file) const {
-    Sprite::Save(file);
-    resourceManager.SaveResourceKey(file, texturePath);
-    resourceManager.SaveResourceKey(file, bounceSoundPath);
+void Wall::OnCollision() const {
+    PlaySound(resourceManager.GetSound(bounceSound));
 }
 
-void Wall::Load(std::ifstream& file) {
-    Sprite::Load(file);
-    texturePath = resourceManager.LoadResourceKey(file);
-    bounceSoundPath = resourceManager.LoadResourceKey(file);
+void Wall::QueueDraw(RenderQueue& queue, uint32_t order, Vector2 position, float rotation) const {
+    Rectangle destination = { position.x, position.y, Size().x, Size().y };
+    Vector2 origin = { Size().x / 2.0f, Size().y / 2.0f };
+    const AtlasRegion& region = resourceManager.GetTexture(texture);
+
+    queue.Add({ TerrainLayer, order, region.texture, region.source, destination, origin, rotation });
+}
+
+void Wall::Save(EntityRecord& record, SnapshotStringTable& strings) const {
+    Sprite::Save(record, strings);
+    record.texture = strings.Intern(resourceManager.GetTexturePath(texture));
+    record.sound = strings.Intern(resourceManager.GetSoundPath(bounceSound));
+}
 
-    texture = resourceManager.GetTexture(texturePath, size.x, size.y);
-    bounceSound = resourceManager.GetSound(bounceSoundPath);
+void Wall::Load(const EntityRecord& record, const SnapshotStringTable& strings) {
+    Sprite::Load(record, strings);
+    TextureHandle loadedTexture = resourceManager.RequestTexture(strings, record.texture, Size().x, Size().y);
+    SoundHandle loadedSound = resourceManager.RequestSound(strings, record.sound);
+    // Retained before the old handles are released, so assets shared by both are never evicted
+    resourceManager.Retain(loadedTexture);
+    resourceManager.Retain(loadedSound);
+    resourceManager.Release(texture);
+    resourceManager.Release(bounceSound);
+    texture = loadedTexture;
+    bounceSound = loadedSound;
 }
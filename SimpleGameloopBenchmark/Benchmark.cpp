@@ -0,0 +1,859 @@
+#include "ResourceManager.h"
+#include "GameState.h"
+#include "SpriteFactory.h"
+#include "SpriteRegistry.h"
+#include "PhysicsKernel.h"
+#include "JobSystem.h"
+#include "MappedFile.h"
+#include "InputRecording.h"
+#include "RewindBuffer.h"
+#include "Snapshot.h"
+#include "SnapshotWriter.h"
+#include "ObjectPool.h"
+#include "TextureAtlas.h"
+#include "Player.h"
+#include "Background.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Headless driver for GameState::Update: no window, no audio device, fixed timestep.
+// Usage: SimpleGameloopBenchmark [--mode loop|kernel|snapshot|rewind|replay|alloc|render|atlas|churn] [--scene mixed|players|walls|platforms|hierarchy]
+//                                [--entities 1000,10000,...] [--ticks N] [--threads 1,2,4,...]
+//                                [--broadphase quadtree,sap,grid] [--cellsize N] [--keyframe N]
+//                                [--replay FILE] [--expect CHECKSUM]
+// Every scene is run once per broad phase and thread count; the speedup column is relative to
+// the first thread count of the same broad phase.
+// --mode kernel times the fused integrate/bounds kernel on every SIMD level the CPU supports.
+// --mode snapshot times each stage of saving and loading the scene through a snapshot file, loading
+// it both through a stream read and through a memory mapping.
+// --mode rewind records --ticks ticks into a RewindBuffer holding all of them, with a keyframe every
+// --keyframe N ticks, and times recording and rewinding to the best and worst placed ticks.
+// --mode replay --replay FILE runs an input recording saved by the game (key 2) headlessly and
+// prints a checksum of the final state; with --expect CHECKSUM it exits with 1 on a mismatch.
+// Without --replay it first records --ticks ticks of scripted input over a Background and the mixed
+// scene (--entities, 200 by default), then replays that and expects the recorded run's checksum.
+// --mode alloc counts heap allocations while building the scene, per tick and per load of a saved
+// game, and shows how full each object pool is.
+// --mode render builds the draw list each tick, as the game does before submitting it, for a
+// screen-sized viewport in the middle of the world and for the whole world.
+// --mode atlas packs --entities solid-color images of random sizes into a TextureAtlas on the CPU and
+// reports how many pages they took and how full those pages are.
+// --mode churn loads --ticks levels of --entities players each, cycling through a few levels with
+// textures of their own, and reports resident asset memory with and without a memory budget. It runs
+// once building every level and once restoring one of them from a snapshot.
+
+const float FIXED_DELTA_TIME = 1.0f / 60.0f;
+const float ENTITY_SPACING = 200.0f;
+const unsigned int SCENE_SEED = 12345;
+const int HIERARCHY_DEPTH = 8;
+const Vector2 PLATFORM_VELOCITY = { 100, 0 };
+const int SNAPSHOT_REPEATS = 10;
+const char* SNAPSHOT_BENCHMARK_FILE = "benchmark_snapshot.dat";
+const Vector2 RENDER_VIEWPORT_SIZE = { 1000, 800 };
+const char* REPLAY_BENCHMARK_FILE = "benchmark_replay.rec";
+const Vector2 REPLAY_BACKGROUND_TILE = { 640, 360 };
+const int ATLAS_MIN_IMAGE_SIZE = 16;
+const int ATLAS_MAX_IMAGE_SIZE = 256;
+const int CHURN_LEVEL_COUNT = 8;
+const int CHURN_TEXTURES_PER_LEVEL = 48;
+const int CHURN_TEXTURE_SIZE = 256;
+const size_t CHURN_MEMORY_BUDGET = 64u * 1024 * 1024;
+
+// Every operator new in the process, for --mode alloc
+static std::atomic<size_t> heapAllocations{ 0 };
+
+void* operator new(size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size ? size : 1)) return pointer;
+    throw std::bad_alloc();
+}
+
+// std::stable_sort's buffer comes from here, so it must pair with the free below as well
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+struct BenchmarkOptions {
+    std::string mode = "loop";
+    std::string scene = "mixed";
+    std::vector<int> entityCounts;
+    std::vector<int> threadCounts;
+    std::vector<BroadPhaseType> broadPhases;
+    float cellSize = SpatialHashGrid::DEFAULT_CELL_SIZE;
+    int keyframeInterval = RewindBuffer::DEFAULT_KEYFRAME_INTERVAL;
+    std::string replayFile;
+    std::string expectedChecksum;
+    int ticks = 300;
+};
+
+struct PhaseSamples {
+    std::vector<double> broadPhaseUpdate;
+    std::vector<double> broadPhase;
+    std::vector<double> narrowPhase;
+    std::vector<double> spriteUpdate;
+    std::vector<double> total;
+
+    void Add(const UpdateTimings& timings) {
+        broadPhaseUpdate.push_back(timings.broadPhaseUpdate);
+        broadPhase.push_back(timings.broadPhase);
+        narrowPhase.push_back(timings.narrowPhase);
+        spriteUpdate.push_back(timings.spriteUpdate);
+        total.push_back(timings.Total());
+    }
+};
+
+static double Percentile(std::vector<double> samples, double percentile) {
+    if (samples.empty()) return 0.0;
+    std::sort(samples.begin(), samples.end());
+    size_t rank = static_cast<size_t>(percentile / 100.0 * (samples.size() - 1) + 0.5);
+    return samples[rank];
+}
+
+static std::vector<int> ParseCounts(const char* list) {
+    std::vector<int> counts;
+    std::string token;
+    for (const char* c = list; ; ++c) {
+        if (*c == ',' || *c == '\0') {
+            if (!token.empty()) counts.push_back(std::stoi(token));
+            token.clear();
+            if (*c == '\0') break;
+        }
+        else token += *c;
+    }
+    return counts;
+}
+
+static const char* GetBroadPhaseName(BroadPhaseType type) {
+    switch (type) {
+    case BroadPhaseType::SweepAndPrune: return "sap";
+    case BroadPhaseType::SpatialHash: return "grid";
+    default: return "quadtree";
+    }
+}
+
+static std::vector<BroadPhaseType> ParseBroadPhases(const char* list) {
+    std::vector<BroadPhaseType> types;
+    std::string token;
+    for (const char* c = list; ; ++c) {
+        if (*c == ',' || *c == '\0') {
+            if (token == "quadtree") types.push_back(BroadPhaseType::Quadtree);
+            else if (token == "sap") types.push_back(BroadPhaseType::SweepAndPrune);
+            else if (token == "grid") types.push_back(BroadPhaseType::SpatialHash);
+            token.clear();
+            if (*c == '\0') break;
+        }
+        else token += *c;
+    }
+    return types;
+}
+
+static std::unique_ptr<BroadPhase> CreateBroadPhase(BroadPhaseType type, const Rectangle& world, float cellSize) {
+    switch (type) {
+    case BroadPhaseType::SweepAndPrune: return std::make_unique<SweepAndPrune>();
+    case BroadPhaseType::SpatialHash: return std::make_unique<SpatialHashGrid>(cellSize);
+    default: return std::make_unique<Quadtree>(world);
+    }
+}
+
+static BenchmarkOptions ParseOptions(int argc, char** argv) {
+    BenchmarkOptions options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--mode") == 0) options.mode = argv[i + 1];
+        else if (std::strcmp(argv[i], "--scene") == 0) options.scene = argv[i + 1];
+        else if (std::strcmp(argv[i], "--entities") == 0) options.entityCounts = ParseCounts(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--ticks") == 0) options.ticks = std::stoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--threads") == 0) options.threadCounts = ParseCounts(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--broadphase") == 0) options.broadPhases = ParseBroadPhases(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--cellsize") == 0) options.cellSize = std::stof(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--keyframe") == 0) options.keyframeInterval = std::max(1, std::stoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--replay") == 0) options.replayFile = argv[i + 1];
+        else if (std::strcmp(argv[i], "--expect") == 0) options.expectedChecksum = argv[i + 1];
+    }
+
+    // Replays default to the game's own broad phase; pair order differs between them, and so can the end state
+    if (options.broadPhases.empty() && options.mode == "replay") options.broadPhases = { BroadPhaseType::Quadtree };
+    if (options.broadPhases.empty()) options.broadPhases = { BroadPhaseType::Quadtree, BroadPhaseType::SweepAndPrune, BroadPhaseType::SpatialHash };
+
+    if (options.threadCounts.empty()) {
+        int allThreads = static_cast<int>(JobSystem::DefaultWorkerCount()) + 1;
+        options.threadCounts = { 1 };
+        if (allThreads > 1) options.threadCounts.push_back(allThreads);
+    }
+
+    if (options.entityCounts.empty()) {
+        if (options.mode == "kernel") options.entityCounts = { 10000, 100000, 1000000 };
+        else if (options.mode == "snapshot") options.entityCounts = { 10000, 100000 };
+        else if (options.mode == "rewind") options.entityCounts = { 1000, 10000 };
+        else if (options.mode == "alloc") options.entityCounts = { 10000, 100000 };
+        else if (options.mode == "render") options.entityCounts = { 10000, 100000 };
+        else if (options.mode == "atlas") options.entityCounts = { 100, 1000, 10000 };
+        else if (options.mode == "churn") options.entityCounts = { 1000, 10000 };
+        else if (options.mode == "replay") options.entityCounts = { 200 };
+        else options.entityCounts = { 1000, 10000, 100000 };
+    }
+    return options;
+}
+
+// One batch spread over the whole world, on a grid so density is even, with random velocities
+static void SpawnGrid(GameState& gameState, SpriteType type, int quantity, const Rectangle& world, float maxSpeed, unsigned int seed,
+    Vector2 velocity = { 0, 0 }) {
+    SpawnDescriptor descriptor = { .type = type, .count = quantity, .layout = SpawnLayout::Grid, .bounds = world,
+        .minVelocity = velocity, .maxVelocity = velocity, .seed = seed };
+    if (maxSpeed > 0.0f) {
+        descriptor.minVelocity = { -maxSpeed, -maxSpeed };
+        descriptor.maxVelocity = { maxSpeed, maxSpeed };
+    }
+    gameState.Spawn(descriptor);
+}
+
+// Roots with a chain of attached children below each, like the child sprites main() attaches
+static void SpawnHierarchies(GameState& gameState, ResourceManager& resourceManager, int quantity, const Rectangle& world) {
+    int roots = std::max(1, quantity / (HIERARCHY_DEPTH + 1));
+    std::vector<std::shared_ptr<SceneNode>> rootNodes;
+    SpriteFactory::Spawn({ .type = SpriteType::PlayerSprite, .count = roots, .layout = SpawnLayout::Grid, .bounds = world }, resourceManager,
+        gameState.GetEntityStore(), rootNodes);
+
+    std::vector<std::shared_ptr<SceneNode>> chain;
+    for (auto& root : rootNodes) {
+        chain.clear();
+        SpriteFactory::Spawn({ .type = SpriteType::PlayerSprite, .count = HIERARCHY_DEPTH, .bounds = { -20, 20, 40, 0 } }, resourceManager,
+            gameState.GetEntityStore(), chain);
+
+        SceneNode* parent = root.get();
+        for (auto& child : chain) {
+            SceneNode* next = child.get();
+            parent->AttachChild(std::move(child));
+            parent = next;
+        }
+        gameState.RegisterEntity(std::move(root));
+    }
+}
+
+static void BuildScene(GameState& gameState, ResourceManager& resourceManager, const std::string& scene,
+    int entityCount, const Rectangle& world) {
+    if (scene == "players") SpawnGrid(gameState, SpriteType::PlayerSprite, entityCount, world, 200.0f, SCENE_SEED);
+    else if (scene == "walls") SpawnGrid(gameState, SpriteType::WallSprite, entityCount, world, 0.0f, SCENE_SEED);
+    else if (scene == "platforms") SpawnGrid(gameState, SpriteType::PlatformSprite, entityCount, world, 0.0f, SCENE_SEED, PLATFORM_VELOCITY);
+    else if (scene == "hierarchy") SpawnHierarchies(gameState, resourceManager, entityCount, world);
+    else {
+        SpawnGrid(gameState, SpriteType::PlayerSprite, entityCount / 2, world, 200.0f, SCENE_SEED);
+        SpawnGrid(gameState, SpriteType::PlatformSprite, entityCount / 4, world, 0.0f, SCENE_SEED + 1, PLATFORM_VELOCITY);
+        SpawnGrid(gameState, SpriteType::WallSprite, entityCount - entityCount / 2 - entityCount / 4, world, 0.0f, SCENE_SEED + 2);
+    }
+}
+
+// Returns the median total tick time so later thread counts can report their speedup
+static double RunScene(const BenchmarkOptions& options, int entityCount, BroadPhaseType broadPhase, int threads, double baselineMedian) {
+    float side = std::ceil(std::sqrt(static_cast<float>(entityCount))) * ENTITY_SPACING;
+    Rectangle world = { 0, 0, side, side };
+
+    ResourceManager resourceManager(true);
+    GameState gameState(resourceManager, world, CreateBroadPhase(broadPhase, world, options.cellSize),
+        static_cast<size_t>(std::max(threads, 1) - 1));
+    BuildScene(gameState, resourceManager, options.scene, entityCount, world);
+
+    PhaseSamples samples;
+    for (int tick = 0; tick < options.ticks; ++tick) {
+        gameState.Update(FIXED_DELTA_TIME, static_cast<int>(world.width), static_cast<int>(world.height));
+        samples.Add(gameState.GetLastTimings());
+    }
+
+    double totalSeconds = 0.0;
+    for (double milliseconds : samples.total) totalSeconds += milliseconds / 1000.0;
+    double entitiesPerSecond = totalSeconds > 0.0 ? gameState.GetEntityCount() * options.ticks / totalSeconds : 0.0;
+
+    double median = Percentile(samples.total, 50);
+    if (baselineMedian <= 0.0) baselineMedian = median;
+
+    std::printf("%-10s %-8s %9zu %6d %7d | %8.3f %8.3f | %8.3f %8.3f | %8.3f %8.3f | %8.3f %8.3f | %9.3f %9.3f | %12.0f | %6.2fx\n",
+        options.scene.c_str(), GetBroadPhaseName(broadPhase), gameState.GetEntityCount(), options.ticks, threads,
+        Percentile(samples.broadPhaseUpdate, 50), Percentile(samples.broadPhaseUpdate, 99),
+        Percentile(samples.broadPhase, 50), Percentile(samples.broadPhase, 99),
+        Percentile(samples.narrowPhase, 50), Percentile(samples.narrowPhase, 99),
+        Percentile(samples.spriteUpdate, 50), Percentile(samples.spriteUpdate, 99),
+        median, Percentile(samples.total, 99),
+        entitiesPerSecond, median > 0.0 ? baselineMedian / median : 0.0);
+    std::fflush(stdout);
+    return median;
+}
+
+struct KernelBodies {
+    std::vector<Vector2> positions;
+    std::vector<Vector2> velocities;
+    std::vector<Vector2> sizes;
+    std::vector<Vector2> parentOffsets;
+    std::vector<uint8_t> collidable;
+
+    BodyArrays View() {
+        return { positions.data(), velocities.data(), sizes.data(), parentOffsets.data(), collidable.data(), positions.size() };
+    }
+};
+
+static KernelBodies MakeKernelBodies(int count, const Rectangle& world) {
+    std::mt19937 rng(SCENE_SEED);
+    std::uniform_real_distribution<float> x(world.x, world.x + world.width);
+    std::uniform_real_distribution<float> y(world.y, world.y + world.height);
+    std::uniform_real_distribution<float> speed(-400.0f, 400.0f);
+
+    KernelBodies bodies;
+    for (int i = 0; i < count; ++i) {
+        bodies.positions.push_back({ x(rng), y(rng) });
+        bodies.velocities.push_back({ speed(rng), speed(rng) });
+        bodies.sizes.push_back({ 100, 100 });
+        bodies.parentOffsets.push_back({ 0, 0 });
+        bodies.collidable.push_back(i % 8 != 0);
+    }
+    return bodies;
+}
+
+static void RunKernelBenchmark(const BenchmarkOptions& options) {
+    SimdLevel best = PhysicsKernel::DetectSimdLevel();
+    std::vector<SimdLevel> levels = { SimdLevel::Scalar };
+    if (best >= SimdLevel::SSE2) levels.push_back(SimdLevel::SSE2);
+    if (best >= SimdLevel::AVX2) levels.push_back(SimdLevel::AVX2);
+
+    std::printf("Fused integrate + bounds kernel, %d ticks, best level on this CPU: %s\n", options.ticks, PhysicsKernel::GetSimdLevelName(best));
+    std::printf("%9s %-7s | %10s %10s | %9s | %8s | %s\n", "bodies", "level", "p50 ms", "p99 ms", "ns/body", "speedup", "matches scalar");
+
+    for (int count : options.entityCounts) {
+        float side = std::ceil(std::sqrt(static_cast<float>(count))) * ENTITY_SPACING;
+        Rectangle world = { 0, 0, side, side };
+        KernelBodies reference;
+        double scalarMedian = 0.0;
+
+        for (SimdLevel level : levels) {
+            KernelBodies bodies = MakeKernelBodies(count, world);
+            std::vector<size_t> wallHits;
+            std::vector<double> samples;
+
+            for (int tick = 0; tick < options.ticks; ++tick) {
+                wallHits.clear();
+                auto start = std::chrono::steady_clock::now();
+                PhysicsKernel::IntegrateAndConstrain(level, bodies.View(), FIXED_DELTA_TIME,
+                    static_cast<int>(world.width), static_cast<int>(world.height), wallHits);
+                samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            }
+
+            double median = Percentile(samples, 50);
+            bool matches = true;
+            if (level == SimdLevel::Scalar) {
+                scalarMedian = median;
+                reference = bodies;
+            }
+            else {
+                matches = std::memcmp(reference.positions.data(), bodies.positions.data(), count * sizeof(Vector2)) == 0 &&
+                    std::memcmp(reference.velocities.data(), bodies.velocities.data(), count * sizeof(Vector2)) == 0;
+            }
+
+            std::printf("%9d %-7s | %10.3f %10.3f | %9.3f | %7.2fx | %s\n", count, PhysicsKernel::GetSimdLevelName(level),
+                median, Percentile(samples, 99), median * 1e6 / count, median > 0.0 ? scalarMedian / median : 0.0, matches ? "yes" : "NO");
+            std::fflush(stdout);
+        }
+    }
+}
+
+static double ElapsedMilliseconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void RunSnapshotBenchmark(const BenchmarkOptions& options) {
+    std::printf("Snapshot save/load, median of %d runs, ms\n", SNAPSHOT_REPEATS);
+    std::printf("stream load: ifstream read + copying decode; mapped load: mmap + in-place decode\n");
+    std::printf("async stall: game thread time of SaveGameStateAsync; async total: until the file is on disk\n");
+    std::printf("%-10s %9s %10s | %8s %8s %8s | %8s %8s %8s | %8s %8s | %8s %8s %8s | %8s %8s\n",
+        "scene", "entities", "bytes", "capture", "encode", "write", "read", "decode", "restore", "save", "load",
+        "map", "decode", "load", "stall", "total");
+
+    for (int entityCount : options.entityCounts) {
+        float side = std::ceil(std::sqrt(static_cast<float>(entityCount))) * ENTITY_SPACING;
+        Rectangle world = { 0, 0, side, side };
+
+        ResourceManager resourceManager(true);
+        GameState gameState(resourceManager, world, BroadPhaseType::SpatialHash, 0);
+        BuildScene(gameState, resourceManager, options.scene, entityCount, world);
+        gameState.Update(FIXED_DELTA_TIME, static_cast<int>(world.width), static_cast<int>(world.height));
+
+        std::vector<double> capture, encode, write, read, decode, restore, save, load;
+        std::vector<double> map, viewDecode, mappedLoad, asyncStall, asyncTotal;
+        SnapshotWriter writer;
+        std::vector<uint8_t> buffer;
+        for (int run = 0; run < SNAPSHOT_REPEATS; ++run) {
+            SnapshotData snapshot;
+            auto start = std::chrono::steady_clock::now();
+            gameState.CaptureSnapshot(snapshot);
+            capture.push_back(ElapsedMilliseconds(start));
+
+            start = std::chrono::steady_clock::now();
+            Snapshot::Encode(snapshot, buffer);
+            encode.push_back(ElapsedMilliseconds(start));
+
+            start = std::chrono::steady_clock::now();
+            Snapshot::WriteFile(SNAPSHOT_BENCHMARK_FILE, buffer);
+            write.push_back(ElapsedMilliseconds(start));
+            save.push_back(capture.back() + encode.back() + write.back());
+
+            std::vector<uint8_t> fileBuffer;
+            SnapshotData loaded;
+            start = std::chrono::steady_clock::now();
+            Snapshot::ReadFile(SNAPSHOT_BENCHMARK_FILE, fileBuffer);
+            read.push_back(ElapsedMilliseconds(start));
+
+            start = std::chrono::steady_clock::now();
+            Snapshot::Decode(fileBuffer.data(), fileBuffer.size(), loaded);
+            decode.push_back(ElapsedMilliseconds(start));
+
+            start = std::chrono::steady_clock::now();
+            gameState.RestoreSnapshot(loaded);
+            restore.push_back(ElapsedMilliseconds(start));
+            load.push_back(read.back() + decode.back() + restore.back());
+
+            start = std::chrono::steady_clock::now();
+            auto loadStart = start;
+            MappedFile file(SNAPSHOT_BENCHMARK_FILE);
+            SnapshotView view;
+            map.push_back(ElapsedMilliseconds(start));
+
+            start = std::chrono::steady_clock::now();
+            Snapshot::Decode(file.Data(), file.Size(), view);
+            viewDecode.push_back(ElapsedMilliseconds(start));
+
+            gameState.RestoreSnapshot(view);
+            mappedLoad.push_back(ElapsedMilliseconds(loadStart));
+
+            start = std::chrono::steady_clock::now();
+            gameState.SaveGameStateAsync(writer, SNAPSHOT_BENCHMARK_FILE);
+            asyncStall.push_back(ElapsedMilliseconds(start));
+            writer.Wait();
+            asyncTotal.push_back(ElapsedMilliseconds(start));
+        }
+        std::remove(SNAPSHOT_BENCHMARK_FILE);
+
+        std::printf("%-10s %9zu %10zu | %8.3f %8.3f %8.3f | %8.3f %8.3f %8.3f | %8.3f %8.3f | %8.3f %8.3f %8.3f | %8.3f %8.3f\n",
+            options.scene.c_str(), gameState.GetEntityCount(), buffer.size(),
+            Percentile(capture, 50), Percentile(encode, 50), Percentile(write, 50),
+            Percentile(read, 50), Percentile(decode, 50), Percentile(restore, 50),
+            Percentile(save, 50), Percentile(load, 50),
+            Percentile(map, 50), Percentile(viewDecode, 50), Percentile(mappedLoad, 50),
+            Percentile(asyncStall, 50), Percentile(asyncTotal, 50));
+        std::fflush(stdout);
+    }
+}
+
+static void RunRewindBenchmark(const BenchmarkOptions& options) {
+    std::printf("Rewind buffer, %d ticks at %.0f Hz, keyframe every %d ticks\n", options.ticks, 1.0f / FIXED_DELTA_TIME, options.keyframeInterval);
+    std::printf("record: capture + encode per tick; rewind: rebuild the tick's snapshot + restore the scene, to a keyframe (best) and to the tick before one (worst)\n");
+    std::printf("%-10s %9s | %8s %8s | %10s %9s | %12s | %8s %8s | %8s %8s\n",
+        "scene", "entities", "record", "p99", "keyframe B", "delta B", "KiB/second", "best", "restore", "worst", "restore");
+
+    for (int entityCount : options.entityCounts) {
+        float side = std::ceil(std::sqrt(static_cast<float>(entityCount))) * ENTITY_SPACING;
+        Rectangle world = { 0, 0, side, side };
+
+        ResourceManager resourceManager(true);
+        GameState gameState(resourceManager, world, BroadPhaseType::SpatialHash, 0);
+        BuildScene(gameState, resourceManager, options.scene, entityCount, world);
+
+        RewindBuffer rewind(static_cast<uint32_t>(options.ticks), static_cast<uint32_t>(options.keyframeInterval));
+        std::vector<double> record;
+        gameState.RecordRewindFrame(rewind, 0);
+        for (int tick = 1; tick <= options.ticks; ++tick) {
+            gameState.Update(FIXED_DELTA_TIME, static_cast<int>(world.width), static_cast<int>(world.height));
+            auto start = std::chrono::steady_clock::now();
+            gameState.RecordRewindFrame(rewind, static_cast<uint64_t>(tick));
+            record.push_back(ElapsedMilliseconds(start));
+        }
+
+        size_t keyframes = rewind.GetKeyframeCount();
+        size_t deltas = rewind.GetFrameCount() - keyframes;
+        uint64_t coveredTicks = rewind.GetNewestTick() - rewind.GetOldestTick() + 1;
+        double secondsCovered = coveredTicks * FIXED_DELTA_TIME;
+        double keyframeBytes = keyframes > 0 ? static_cast<double>(rewind.GetKeyframeBytes()) / keyframes : 0.0;
+        double deltaBytes = deltas > 0 ? static_cast<double>(rewind.GetDeltaBytes()) / deltas : 0.0;
+
+        // Best: the newest keyframe. Worst: the tick just before it, which replays a full group of deltas.
+        uint64_t bestTick = rewind.GetOldestTick() + (coveredTicks - 1) / options.keyframeInterval * options.keyframeInterval;
+        uint64_t worstTick = bestTick > rewind.GetOldestTick() ? bestTick - 1 : bestTick;
+
+        SnapshotData snapshot;
+        auto start = std::chrono::steady_clock::now();
+        rewind.Reconstruct(bestTick, snapshot);
+        double bestRebuild = ElapsedMilliseconds(start);
+        start = std::chrono::steady_clock::now();
+        gameState.RestoreSnapshot(snapshot);
+        double bestRestore = ElapsedMilliseconds(start);
+
+        start = std::chrono::steady_clock::now();
+        rewind.Reconstruct(worstTick, snapshot);
+        double worstRebuild = ElapsedMilliseconds(start);
+        start = std::chrono::steady_clock::now();
+        gameState.RestoreSnapshot(snapshot);
+        double worstRestore = ElapsedMilliseconds(start);
+
+        std::printf("%-10s %9zu | %8.3f %8.3f | %10.0f %9.0f | %12.1f | %8.3f %8.3f | %8.3f %8.3f\n",
+            options.scene.c_str(), gameState.GetEntityCount(), Percentile(record, 50), Percentile(record, 99),
+            keyframeBytes, deltaBytes, rewind.GetMemoryBytes() / 1024.0 / secondsCovered,
+            bestRebuild, bestRestore, worstRebuild, worstRestore);
+        std::fflush(stdout);
+    }
+}
+
+// Records a session the way the game does, with input that holds each button combination for a while
+// and turns the wheel every few ticks. The background texture is requested at REPLAY_BACKGROUND_TILE
+// first, standing in for the image the game loads, while the replay gets the headless default size;
+// anything sized by an asset that leaks into the simulation shows up as a mismatch. Returns the
+// checksum the recorded run ended on.
+static std::string RecordScriptedReplay(const BenchmarkOptions& options, const std::string& path) {
+    const int width = static_cast<int>(RENDER_VIEWPORT_SIZE.x);
+    const int height = static_cast<int>(RENDER_VIEWPORT_SIZE.y);
+    const uint32_t buttons[] = { InputState::MoveRight, InputState::MoveRight | InputState::MoveDown, 0, InputState::MoveUp | InputState::MoveLeft };
+    Rectangle screen = { 0, 0, RENDER_VIEWPORT_SIZE.x, RENDER_VIEWPORT_SIZE.y };
+
+    ResourceManager resourceManager(true);
+    resourceManager.RequestTexture(Background::DEFAULT_TEXTURE, static_cast<int>(REPLAY_BACKGROUND_TILE.x), static_cast<int>(REPLAY_BACKGROUND_TILE.y));
+    GameState gameState(resourceManager, screen, CreateBroadPhase(BroadPhaseType::Quadtree, screen, options.cellSize), 0);
+    gameState.Spawn({ .type = SpriteType::BackgroundSprite, .bounds = screen });
+    BuildScene(gameState, resourceManager, "mixed", options.entityCounts.front(), screen);
+
+    SnapshotData startState;
+    gameState.CaptureSnapshot(startState);
+    InputRecording recording(1.0f / FIXED_DELTA_TIME, width, height, startState);
+    for (int tick = 0; tick < options.ticks; ++tick) {
+        InputState input;
+        input.buttons = buttons[(tick / 40) % 4];
+        input.mousePosition = { static_cast<float>(tick % width), static_cast<float>(tick % height) };
+        if (tick % 5 == 0) input.wheelMove = { 0, (tick / 5) % 2 ? 1.0f : -1.5f };
+        gameState.Update(FIXED_DELTA_TIME, width, height, input);
+        recording.Add(input);
+    }
+    recording.Save(path);
+
+    char checksum[16];
+    std::snprintf(checksum, sizeof(checksum), "%08x", gameState.ComputeStateChecksum());
+    return checksum;
+}
+
+// Returns false if any run ends in a state other than --expect
+static bool RunReplayBenchmark(const BenchmarkOptions& options) {
+    std::string replayFile = options.replayFile;
+    std::string expectedChecksum = options.expectedChecksum;
+    if (replayFile.empty()) {
+        replayFile = REPLAY_BENCHMARK_FILE;
+        try {
+            expectedChecksum = RecordScriptedReplay(options, replayFile);
+        }
+        catch (const std::exception& e) {
+            std::fprintf(stderr, "Error recording %s: %s\n", replayFile.c_str(), e.what());
+            return false;
+        }
+        std::printf("Recorded %d scripted ticks, checksum %s\n", options.ticks, expectedChecksum.c_str());
+    }
+
+    InputRecording recording;
+    SnapshotData startState;
+    try {
+        recording = InputRecording::Load(replayFile);
+        recording.DecodeStartState(startState);
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "Error loading %s: %s\n", replayFile.c_str(), e.what());
+        return false;
+    }
+    if (options.replayFile.empty()) std::remove(REPLAY_BENCHMARK_FILE);
+    float deltaTime = 1.0f / recording.GetTickRate();
+
+    std::printf("Replay of %s: %zu ticks at %.0f Hz, %dx%d, %zu entities\n", replayFile.c_str(), recording.GetTickCount(),
+        recording.GetTickRate(), recording.GetScreenWidth(), recording.GetScreenHeight(), startState.records.size());
+    std::printf("%-8s %7s | %8s %8s | %9s | %10s\n", "broad", "threads", "tick p50", "p99", "total ms", "checksum");
+
+    bool matched = true;
+    for (BroadPhaseType broadPhase : options.broadPhases) {
+        for (int threads : options.threadCounts) {
+            Rectangle screen = { 0, 0, static_cast<float>(recording.GetScreenWidth()), static_cast<float>(recording.GetScreenHeight()) };
+            ResourceManager resourceManager(true);
+            GameState gameState(resourceManager, screen, CreateBroadPhase(broadPhase, screen, options.cellSize),
+                static_cast<size_t>(std::max(threads, 1) - 1));
+            gameState.RestoreSnapshot(startState);
+
+            std::vector<double> ticks;
+            double totalMilliseconds = 0.0;
+            for (size_t tick = 0; tick < recording.GetTickCount(); ++tick) {
+                auto start = std::chrono::steady_clock::now();
+                gameState.Update(deltaTime, recording.GetScreenWidth(), recording.GetScreenHeight(), recording.GetInput(tick));
+                ticks.push_back(ElapsedMilliseconds(start));
+                totalMilliseconds += ticks.back();
+            }
+
+            char checksum[16];
+            std::snprintf(checksum, sizeof(checksum), "%08x", gameState.ComputeStateChecksum());
+            bool expected = expectedChecksum.empty() || expectedChecksum == checksum;
+            matched = matched && expected;
+
+            std::printf("%-8s %7d | %8.3f %8.3f | %9.1f | %10s%s\n", GetBroadPhaseName(broadPhase), threads,
+                Percentile(ticks, 50), Percentile(ticks, 99), totalMilliseconds, checksum, expected ? "" : "  MISMATCH");
+            std::fflush(stdout);
+        }
+    }
+    return matched;
+}
+
+static void PrintPoolStats(const char* name, const PoolStats& stats) {
+    std::printf("  %-10s %9zu %9zu %9zu %7zu\n", name, stats.liveObjects, stats.capacity, stats.allocations, stats.chunkAllocations);
+}
+
+static void RunAllocationBenchmark(const BenchmarkOptions& options) {
+    std::printf("Heap allocations (operator new calls); load: LoadGameState of the saved scene, first and median of the next %d\n", SNAPSHOT_REPEATS - 1);
+    std::printf("%-10s %9s | %9s %7s | %8s %8s | %9s %9s %7s\n",
+        "scene", "entities", "build", "/entity", "tick p50", "max", "load 1st", "load p50", "/entity");
+
+    for (int entityCount : options.entityCounts) {
+        float side = std::ceil(std::sqrt(static_cast<float>(entityCount))) * ENTITY_SPACING;
+        Rectangle world = { 0, 0, side, side };
+
+        ResourceManager resourceManager(true);
+        GameState gameState(resourceManager, world, BroadPhaseType::SpatialHash, 0);
+        size_t before = heapAllocations;
+        BuildScene(gameState, resourceManager, options.scene, entityCount, world);
+        size_t build = heapAllocations - before;
+        size_t entities = gameState.GetEntityCount();
+
+        std::vector<double> ticks;
+        for (int tick = 0; tick < options.ticks; ++tick) {
+            before = heapAllocations;
+            gameState.Update(FIXED_DELTA_TIME, static_cast<int>(world.width), static_cast<int>(world.height));
+            ticks.push_back(static_cast<double>(heapAllocations - before));
+        }
+
+        gameState.SaveGameState(SNAPSHOT_BENCHMARK_FILE);
+        std::vector<double> loads;
+        for (int run = 0; run < SNAPSHOT_REPEATS; ++run) {
+            before = heapAllocations;
+            gameState.LoadGameState(SNAPSHOT_BENCHMARK_FILE);
+            loads.push_back(static_cast<double>(heapAllocations - before));
+        }
+        std::remove(SNAPSHOT_BENCHMARK_FILE);
+
+        double laterLoads = Percentile(std::vector<double>(loads.begin() + 1, loads.end()), 50);
+        std::printf("%-10s %9zu | %9zu %7.2f | %8.0f %8.0f | %9.0f %9.0f %7.2f\n",
+            options.scene.c_str(), entities, build, static_cast<double>(build) / entities,
+            Percentile(ticks, 50), *std::max_element(ticks.begin(), ticks.end()),
+            loads.front(), laterLoads, laterLoads / entities);
+
+        std::printf("  %-10s %9s %9s %9s %7s\n", "pool", "live", "capacity", "handed out", "chunks");
+        PrintPoolStats("SceneNode", ObjectPool::GetStats<SceneNode>());
+        for (const SpriteTypeInfo& type : SpriteRegistry::GetAll()) PrintPoolStats(type.name, type.getPoolStats());
+        std::fflush(stdout);
+    }
+}
+
+static void RunRenderBenchmark(const BenchmarkOptions& options) {
+    std::printf("Draw list build (GameState::PrepareDraw) in ms per frame (p50 p99), one frame per tick\n");
+    std::printf("%-10s %-8s %9s %-8s | %9s %9s %9s | %8s %8s\n",
+        "scene", "broad", "entities", "view", "visible", "quads", "batches", "p50", "p99");
+
+    for (int entityCount : options.entityCounts) {
+        float side = std::ceil(std::sqrt(static_cast<float>(entityCount))) * ENTITY_SPACING;
+        Rectangle world = { 0, 0, side, side };
+        Rectangle screen = { (side - RENDER_VIEWPORT_SIZE.x) / 2, (side - RENDER_VIEWPORT_SIZE.y) / 2, RENDER_VIEWPORT_SIZE.x, RENDER_VIEWPORT_SIZE.y };
+        const std::pair<const char*, Rectangle> viewports[] = { { "screen", screen }, { "world", world } };
+
+        for (BroadPhaseType broadPhase : options.broadPhases) {
+            for (const auto& [viewName, viewport] : viewports) {
+                ResourceManager resourceManager(true);
+                GameState gameState(resourceManager, world, CreateBroadPhase(broadPhase, world, options.cellSize), 0);
+                BuildScene(gameState, resourceManager, options.scene, entityCount, world);
+
+                std::vector<double> frames;
+                for (int tick = 0; tick < options.ticks; ++tick) {
+                    gameState.Update(FIXED_DELTA_TIME, static_cast<int>(world.width), static_cast<int>(world.height));
+                    auto start = std::chrono::steady_clock::now();
+                    gameState.PrepareDraw(1.0f, viewport);
+                    frames.push_back(ElapsedMilliseconds(start));
+                }
+
+                const RenderStats& stats = gameState.GetLastRenderStats();
+                std::printf("%-10s %-8s %9zu %-8s | %9zu %9zu %9zu | %8.3f %8.3f\n",
+                    options.scene.c_str(), GetBroadPhaseName(broadPhase), gameState.GetEntityCount(), viewName,
+                    stats.visibleNodes, stats.quads, stats.batches, Percentile(frames, 50), Percentile(frames, 99));
+                std::fflush(stdout);
+            }
+        }
+    }
+}
+
+static void RunAtlasBenchmark(const BenchmarkOptions& options) {
+    std::printf("Atlas packing of images %d-%d px a side, %dx%d pages\nOccupancy excludes padding and averages every page but the last\n",
+        ATLAS_MIN_IMAGE_SIZE, ATLAS_MAX_IMAGE_SIZE, TextureAtlas::PAGE_SIZE, TextureAtlas::PAGE_SIZE);
+    std::printf("%9s | %6s %9s %9s | %9s\n", "images", "pages", "occupancy", "last page", "us/image");
+
+    for (int imageCount : options.entityCounts) {
+        std::mt19937 rng(SCENE_SEED);
+        std::uniform_int_distribution<int> side(ATLAS_MIN_IMAGE_SIZE, ATLAS_MAX_IMAGE_SIZE);
+        std::uniform_int_distribution<int> channel(0, 255);
+        std::vector<Image> images;
+        images.reserve(imageCount);
+        for (int i = 0; i < imageCount; ++i) {
+            Color color = { static_cast<unsigned char>(channel(rng)), static_cast<unsigned char>(channel(rng)), static_cast<unsigned char>(channel(rng)), 255 };
+            images.push_back(GenImageColor(side(rng), side(rng), color));
+        }
+
+        TextureAtlas atlas(false);
+        auto start = std::chrono::steady_clock::now();
+        for (const Image& image : images) atlas.Add(image);
+        double milliseconds = ElapsedMilliseconds(start);
+        for (const Image& image : images) UnloadImage(image);
+
+        size_t pages = atlas.GetPageCount();
+        double occupancy = 0.0;
+        for (uint32_t page = 0; page + 1 < pages; ++page) occupancy += atlas.GetOccupancy(page);
+        if (pages > 1) occupancy /= pages - 1;
+        else occupancy = atlas.GetOccupancy(0);
+
+        std::printf("%9d | %6zu %8.1f%% %8.1f%% | %9.2f\n", imageCount, pages, occupancy * 100.0,
+            atlas.GetOccupancy(static_cast<uint32_t>(pages - 1)) * 100.0, milliseconds * 1000.0 / imageCount);
+        std::fflush(stdout);
+    }
+}
+
+static std::shared_ptr<Sprite> MakeChurnPlayer(ResourceManager& resourceManager, int levelIndex, int i) {
+    std::string texturePath = "level" + std::to_string(levelIndex) + "/sprite" + std::to_string(i % CHURN_TEXTURES_PER_LEVEL) + ".png";
+    return ObjectPool::MakeShared<Player>(resourceManager, Vector2{ i * ENTITY_SPACING, 0 },
+        Vector2{ static_cast<float>(CHURN_TEXTURE_SIZE), static_cast<float>(CHURN_TEXTURE_SIZE) }, Circular, texturePath);
+}
+
+// Each level is unloaded before the next is built, as a level change in the game would; Update then
+// evicts what the new level no longer uses. With fromSnapshot level 0 is a saved game, restored each
+// time round, so its assets are looked up through the snapshot string table after they were evicted.
+static void RunChurnLevels(const BenchmarkOptions& options, int playersPerLevel, size_t memoryBudget, bool fromSnapshot) {
+    Rectangle world = { 0, 0, playersPerLevel * ENTITY_SPACING, ENTITY_SPACING };
+    SnapshotData savedLevel;
+    if (fromSnapshot) {
+        ResourceManager builderResources(true);
+        GameState builder(builderResources, world, BroadPhaseType::SpatialHash, 0);
+        for (int i = 0; i < playersPerLevel; ++i)
+            builder.RegisterEntity(ObjectPool::MakeShared<SceneNode>(MakeChurnPlayer(builderResources, 0, i), builderResources));
+        builder.CaptureSnapshot(savedLevel);
+    }
+
+    ResourceManager resourceManager(true, memoryBudget);
+    GameState gameState(resourceManager, world, BroadPhaseType::SpatialHash, 0);
+    std::vector<std::shared_ptr<Sprite>> level;
+    level.reserve(playersPerLevel);
+    size_t peakBytes = 0;
+    size_t restoreMisses = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < options.ticks; ++tick) {
+        int levelIndex = tick % CHURN_LEVEL_COUNT;
+        level.clear();
+        if (fromSnapshot && levelIndex == 0) {
+            size_t missesBefore = resourceManager.GetStats().misses;
+            gameState.RestoreSnapshot(savedLevel);
+            restoreMisses += resourceManager.GetStats().misses - missesBefore;
+        }
+        else {
+            if (fromSnapshot) gameState.RestoreSnapshot(SnapshotData{});
+            for (int i = 0; i < playersPerLevel; ++i) level.push_back(MakeChurnPlayer(resourceManager, levelIndex, i));
+        }
+        resourceManager.Update();
+        peakBytes = std::max(peakBytes, resourceManager.GetStats().residentBytes);
+    }
+    double milliseconds = ElapsedMilliseconds(start);
+
+    ResourceStats stats = resourceManager.GetStats();
+    const double megabyte = 1024.0 * 1024.0;
+    std::string budget = memoryBudget == SIZE_MAX ? "none" : std::to_string(memoryBudget / (1024 * 1024)) + " MB";
+    std::string restored = fromSnapshot ? std::to_string(restoreMisses) : "-";
+    std::printf("%-8s %9d %7d | %8s | %8.1f %8.1f | %9zu %9zu %9zu %9s | %9.3f\n", fromSnapshot ? "snapshot" : "build",
+        playersPerLevel, options.ticks, budget.c_str(), peakBytes / megabyte, stats.residentBytes / megabyte,
+        stats.hits, stats.misses, stats.evictions, restored.c_str(), milliseconds / options.ticks);
+    std::fflush(stdout);
+}
+
+static void RunChurnBenchmark(const BenchmarkOptions& options) {
+    std::printf("Level churn over %d levels of %d textures, %dx%d px each; resident memory in MB after each level's Update\n",
+        CHURN_LEVEL_COUNT, CHURN_TEXTURES_PER_LEVEL, CHURN_TEXTURE_SIZE, CHURN_TEXTURE_SIZE);
+    std::printf("build: every level created from texture paths; snapshot: level 0 restored from a saved game\n");
+    std::printf("restored: misses while restoring level 0, i.e. its textures loaded again after eviction\n");
+    std::printf("%-8s %9s %7s | %8s | %8s %8s | %9s %9s %9s %9s | %9s\n",
+        "load", "players", "levels", "budget", "peak", "final", "hits", "misses", "evictions", "restored", "ms/level");
+
+    for (int playersPerLevel : options.entityCounts) {
+        for (bool fromSnapshot : { false, true }) {
+            RunChurnLevels(options, playersPerLevel, SIZE_MAX, fromSnapshot);
+            RunChurnLevels(options, playersPerLevel, CHURN_MEMORY_BUDGET, fromSnapshot);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options = ParseOptions(argc, argv);
+
+    if (options.mode == "kernel") {
+        RunKernelBenchmark(options);
+        return 0;
+    }
+    if (options.mode == "snapshot") {
+        RunSnapshotBenchmark(options);
+        return 0;
+    }
+    if (options.mode == "rewind") {
+        RunRewindBenchmark(options);
+        return 0;
+    }
+    if (options.mode == "replay") return RunReplayBenchmark(options) ? 0 : 1;
+    if (options.mode == "alloc") {
+        RunAllocationBenchmark(options);
+        return 0;
+    }
+    if (options.mode == "render") {
+        RunRenderBenchmark(options);
+        return 0;
+    }
+    if (options.mode == "atlas") {
+        RunAtlasBenchmark(options);
+        return 0;
+    }
+    if (options.mode == "churn") {
+        RunChurnBenchmark(options);
+        return 0;
+    }
+
+    std::printf("All timings in ms per tick (p50 p99), fixed dt = %.4f s\n", FIXED_DELTA_TIME);
+    std::printf("%-10s %-8s %9s %6s %7s | %-17s | %-17s | %-17s | %-17s | %-19s | %12s | %s\n",
+        "scene", "broad", "entities", "ticks", "threads", "broad update", "broad pairs", "narrow phase", "sprite update", "total", "entities/s", "speedup");
+
+    for (int entityCount : options.entityCounts) {
+        for (BroadPhaseType broadPhase : options.broadPhases) {
+            double baselineMedian = 0.0;
+            for (int threads : options.threadCounts) {
+                double median = RunScene(options, entityCount, broadPhase, threads, baselineMedian);
+                if (baselineMedian <= 0.0) baselineMedian = median;
+            }
+        }
+    }
+    return 0;
+}